@@ -33,6 +33,7 @@ unix:!macx {
     SOURCES += \
           ../hidapi-0.7.0/linux/hid.c
     LIBS += `pkg-config libudev --libs`
+    LIBS += -lpthread
 
 }
 
@@ -64,13 +65,18 @@ macx {
 }
 
 HEADERS += saitekpanels.h \
-      inireader.h
+      inireader.h \
+      panelreport.h \
+      bipclassify.h \
+      bipexpr.h
 
 SOURCES += saitekpanels.cpp\
     radiopanels.cpp \
     multipanel.cpp \
     switchpanel.cpp \
     bippanel.cpp \
+    bipclassify.cpp \
+    bipexpr.cpp \
     inireader.cpp \
     readinifile.cpp
 
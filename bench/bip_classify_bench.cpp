@@ -0,0 +1,104 @@
+// ****** bip_classify_bench.cpp **********
+// Times the BIP range classification over rule tables the size of a small,
+// a typical and a very large D2B_config, with the scalar loop and every
+// SIMD path this CPU runs, and checks each against the scalar masks.
+//
+//   bip_classify_bench [passes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <vector>
+
+#include "../bipclassify.h"
+
+#define FRAMES 16
+
+// * FRAMES sets of values that drift a little, the way a sim moves them *
+struct Table {
+    std::vector<float> value[FRAMES], low, high;
+    std::vector<unsigned int> mask;
+};
+
+static double now_us()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double) tv.tv_sec * 1000000.0 + (double) tv.tv_usec;
+}
+
+// * gauge style ranges, about a third of the rules lit *
+static void synthesise(Table &t, int count)
+{
+    int n, f, padded = (count + BIP_CLASSIFY_WIDTH - 1) & ~(BIP_CLASSIFY_WIDTH - 1);
+
+    t.value[0].assign(padded, 0.0f);
+    t.low.assign(padded, 1.0f);
+    t.high.assign(padded, 0.0f);
+    t.mask.assign(BIP_CLASSIFY_WORDS(padded), 0);
+    srand(count);
+    for (n = 0; n < count; n++) {
+        t.low[n] = (float) (rand() % 100);
+        t.high[n] = t.low[n] + (float) (rand() % 50);
+        t.value[0][n] = (float) (rand() % 150);
+    }
+    for (f = 1; f < FRAMES; f++) {
+        t.value[f] = t.value[f - 1];
+        for (n = 0; n < count; n++) {
+            t.value[f][n] += (float) (rand() % 5) - 2.0f;
+        }
+    }
+}
+
+// * out gets every frame's mask, so the paths can be compared *
+static double run(const char *path, Table &t, int passes, std::vector<unsigned int> &out)
+{
+    double start, spent;
+    int p, f, count = (int) t.low.size();
+
+    bip_classify_select(path);
+    start = now_us();
+    for (p = 0; p < passes; p++) {
+        bip_classify(&t.value[p % FRAMES][0], &t.low[0], &t.high[0], count, &t.mask[0]);
+    }
+    spent = now_us() - start;
+
+    out.clear();
+    for (f = 0; f < FRAMES; f++) {
+        bip_classify(&t.value[f][0], &t.low[0], &t.high[0], count, &t.mask[0]);
+        out.insert(out.end(), t.mask.begin(), t.mask.end());
+    }
+    return spent * 1000.0 / passes;
+}
+
+int main(int argc, char **argv)
+{
+    static const int sizes[3] = {24, 200, 1000};
+    static const char *paths[3] = {"scalar", "sse2", "avx2"};
+    std::vector<unsigned int> reference, mask;
+    int passes = (argc > 1) ? atoi(argv[1]) : 200000;
+    int s, p;
+
+    for (s = 0; s < 3; s++) {
+        for (p = 0; p < 3; p++) {
+            Table t;
+            double ns;
+
+            if (!bip_classify_select(paths[p])) {
+                printf("%5d rules  %-7s not available on this CPU\n", sizes[s], paths[p]);
+                continue;
+            }
+            synthesise(t, sizes[s]);
+            ns = run(paths[p], t, passes, mask);
+            if (p == 0) {
+                reference = mask;
+            }
+            printf("%5d rules  %-7s %10.1f ns/frame  %6.2f ns/rule  %s\n", sizes[s], paths[p], ns, ns / sizes[s],
+                   (mask == reference) ? "ok" : "MISMATCH");
+        }
+    }
+    return 0;
+}
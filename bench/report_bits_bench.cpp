@@ -0,0 +1,164 @@
+// ****** report_bits_bench.cpp **********
+// Replays switch panel input reports through the old testbit() checks and
+// through the panel_word path from panelreport.h, and times both.
+//
+//   report_bits_bench [reports.bin] [passes]
+//
+// reports.bin is a capture of raw 3 byte reports. Without one a session is
+// synthesised: mostly repeated reports with the odd switch flipped, the
+// way a panel sends them.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <vector>
+
+#define IBM 0
+#include "../panelreport.h"
+
+#define testbit(x, y)  ( ( ((const char*)&(x))[(y)>>3] & 0x80 >> ((y)&0x07)) >> (7-((y)&0x07) ) )
+
+struct Report {
+    unsigned char buf[4];
+};
+
+static double now_us()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double) tv.tv_sec * 1000000.0 + (double) tv.tv_usec;
+}
+
+static void synthesise(std::vector<Report> &reports, int count)
+{
+    Report r;
+    int i, bit;
+
+    memset(&r, 0, sizeof(r));
+    srand(1234);
+    for (i = 0; i < count; i++) {
+        if ((rand() % 8) == 0) {
+            bit = rand() % PANEL_REPORT_BITS;
+            r.buf[bit >> 3] ^= 0x80 >> (bit & 0x07);
+        }
+        reports.push_back(r);
+    }
+}
+
+static int load(std::vector<Report> &reports, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    Report r;
+
+    if (f == NULL) {
+        return 0;
+    }
+    memset(&r, 0, sizeof(r));
+    while (fread(r.buf, 1, 3, f) == 3) {
+        reports.push_back(r);
+    }
+    fclose(f);
+    return 1;
+}
+
+// * the old handlers: every switch tests its own bit on every report *
+static unsigned int replay_testbit(const std::vector<Report> &reports)
+{
+    unsigned int sum = 0;
+    size_t i;
+    int bit;
+
+    for (i = 0; i < reports.size(); i++) {
+        for (bit = 0; bit < PANEL_REPORT_BITS; bit++) {
+            if (testbit(reports[i].buf, bit)) {
+                sum += bit;
+            }
+        }
+    }
+    return sum;
+}
+
+// * the same checks against a word loaded once per report *
+static unsigned int replay_word(const std::vector<Report> &reports)
+{
+    unsigned int sum = 0;
+    size_t i;
+    int bit;
+
+    for (i = 0; i < reports.size(); i++) {
+        panel_word word = panel_report_word(reports[i].buf);
+        for (bit = 0; bit < PANEL_REPORT_BITS; bit++) {
+            if (word & PANEL_BIT(bit)) {
+                sum += bit;
+            }
+        }
+    }
+    return sum;
+}
+
+// * only the bits that changed since the last report, found with ctz *
+static unsigned int replay_changed(const std::vector<Report> &reports)
+{
+    unsigned int sum = 0;
+    panel_word last = 0, changed;
+    size_t i;
+    int bit;
+
+    for (i = 0; i < reports.size(); i++) {
+        panel_word word = panel_report_word(reports[i].buf);
+        for (changed = word ^ last; changed != 0; changed &= changed - 1) {
+            bit = panel_ctz(changed);
+            if (word & PANEL_BIT(bit)) {
+                sum += bit;
+            }
+        }
+        last = word;
+    }
+    return sum;
+}
+
+static void run(const char *name, unsigned int (*replay)(const std::vector<Report> &),
+                const std::vector<Report> &reports, int passes)
+{
+    unsigned int sum = 0;
+    double start, spent;
+    int p;
+
+    start = now_us();
+    for (p = 0; p < passes; p++) {
+        sum += replay(reports);
+    }
+    spent = now_us() - start;
+    printf("%-10s %10.2f ns/report  (check %u)\n", name,
+           spent * 1000.0 / ((double) reports.size() * passes), sum);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Report> reports;
+    int passes = 200;
+
+    if (argc > 1) {
+        if (!load(reports, argv[1])) {
+            fprintf(stderr, "can not read %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        synthesise(reports, 100000);
+    }
+    if (argc > 2) {
+        passes = atoi(argv[2]);
+    }
+    if (reports.empty() || (passes <= 0)) {
+        return 1;
+    }
+
+    printf("%d reports, %d passes\n", (int) reports.size(), passes);
+    run("testbit", replay_testbit, reports, passes);
+    run("word", replay_word, reports, passes);
+    run("changed", replay_changed, reports, passes);
+    return 0;
+}
@@ -0,0 +1,162 @@
+// ****** bipclassify.cpp **********
+// Range tests for the BIP rule tables, see bipclassify.h.
+
+#include "bipclassify.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BIP_CLASSIFY_SSE2 1
+#include <emmintrin.h>
+#else
+#define BIP_CLASSIFY_SSE2 0
+#endif
+
+// * AVX2 is built with a target attribute, the rest of the plugin stays baseline *
+#if BIP_CLASSIFY_SSE2 && (defined(__GNUC__) || defined(_MSC_VER))
+#define BIP_CLASSIFY_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BIP_TARGET_AVX2
+#else
+#define BIP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define BIP_CLASSIFY_AVX2 0
+#endif
+
+typedef void (*BipClassifyFunction)(const float *, const float *, const float *, int, unsigned int *);
+
+static BipClassifyFunction bipclassifyfunction = NULL;
+static const char *bipclassifypath = "scalar";
+
+static void bip_classify_scalar(const float *value, const float *low, const float *high, int count, unsigned int *mask)
+{
+    int n;
+
+    memset(mask, 0, BIP_CLASSIFY_WORDS(count) * sizeof(unsigned int));
+    for (n = 0; n < count; n++) {
+        if ((value[n] >= low[n]) && (value[n] <= high[n])) {
+            mask[n >> 5] |= 1u << (n & 31);
+        }
+    }
+}
+
+#if BIP_CLASSIFY_SSE2
+static void bip_classify_sse2(const float *value, const float *low, const float *high, int count, unsigned int *mask)
+{
+    int n, last = count & ~3;
+
+    memset(mask, 0, BIP_CLASSIFY_WORDS(count) * sizeof(unsigned int));
+    for (n = 0; n < last; n += 4) {
+        __m128 v = _mm_loadu_ps(value + n);
+        __m128 in = _mm_and_ps(_mm_cmpge_ps(v, _mm_loadu_ps(low + n)),
+                               _mm_cmple_ps(v, _mm_loadu_ps(high + n)));
+        mask[n >> 5] |= (unsigned int) _mm_movemask_ps(in) << (n & 31);
+    }
+    for (; n < count; n++) {
+        if ((value[n] >= low[n]) && (value[n] <= high[n])) {
+            mask[n >> 5] |= 1u << (n & 31);
+        }
+    }
+}
+#endif
+
+#if BIP_CLASSIFY_AVX2
+BIP_TARGET_AVX2
+static void bip_classify_avx2(const float *value, const float *low, const float *high, int count, unsigned int *mask)
+{
+    int n, last = count & ~7;
+
+    memset(mask, 0, BIP_CLASSIFY_WORDS(count) * sizeof(unsigned int));
+    for (n = 0; n < last; n += 8) {
+        __m256 v = _mm256_loadu_ps(value + n);
+        __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, _mm256_loadu_ps(low + n), _CMP_GE_OQ),
+                                  _mm256_cmp_ps(v, _mm256_loadu_ps(high + n), _CMP_LE_OQ));
+        mask[n >> 5] |= (unsigned int) _mm256_movemask_ps(in) << (n & 31);
+    }
+    for (; n < count; n++) {
+        if ((value[n] >= low[n]) && (value[n] <= high[n])) {
+            mask[n >> 5] |= 1u << (n & 31);
+        }
+    }
+}
+
+static int bip_cpu_has_avx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return 0;
+    }
+    __cpuid(info, 1);
+    // * OSXSAVE and AVX, and the OS saves the YMM registers *
+    if (((info[2] & (1 << 27)) == 0) || ((info[2] & (1 << 28)) == 0)) {
+        return 0;
+    }
+    if ((_xgetbv(0) & 6) != 6) {
+        return 0;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+int bip_classify_select(const char *path)
+{
+    if (strcmp(path, "scalar") == 0) {
+        bipclassifyfunction = bip_classify_scalar;
+        bipclassifypath = "scalar";
+        return 1;
+    }
+#if BIP_CLASSIFY_SSE2
+    if (strcmp(path, "sse2") == 0) {
+        bipclassifyfunction = bip_classify_sse2;
+        bipclassifypath = "sse2";
+        return 1;
+    }
+#endif
+#if BIP_CLASSIFY_AVX2
+    if ((strcmp(path, "avx2") == 0) && bip_cpu_has_avx2()) {
+        bipclassifyfunction = bip_classify_avx2;
+        bipclassifypath = "avx2";
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+// * the widest path this CPU runs *
+static void bip_classify_pick()
+{
+    if (bip_classify_select("avx2")) {
+        return;
+    }
+    if (bip_classify_select("sse2")) {
+        return;
+    }
+    bip_classify_select("scalar");
+}
+
+const char *bip_classify_path()
+{
+    if (bipclassifyfunction == NULL) {
+        bip_classify_pick();
+    }
+    return bipclassifypath;
+}
+
+void bip_classify(const float *value, const float *low, const float *high, int count, unsigned int *mask)
+{
+    if (bipclassifyfunction == NULL) {
+        bip_classify_pick();
+    }
+    bipclassifyfunction(value, low, high, count, mask);
+}
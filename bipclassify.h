@@ -0,0 +1,23 @@
+#ifndef BIPCLASSIFY_H
+#define BIPCLASSIFY_H
+
+// ****** bipclassify.h **********
+// BIP rules light an indicator while their value is inside a range. Once a
+// frame's values are gathered next to the ranges, every rule is tested at
+// once: SSE2 four at a time, AVX2 eight at a time where the CPU has it,
+// picked when the first table is classified.
+//
+// value, low and high hold count floats each. Bit n of mask is set when
+// low[n] <= value[n] <= high[n]; mask needs BIP_CLASSIFY_WORDS(count) words.
+// A NaN value is never in range, the same as the scalar test.
+
+#define BIP_CLASSIFY_WIDTH 8
+#define BIP_CLASSIFY_WORDS(count) (((count) + 31) / 32)
+
+void bip_classify(const float *value, const float *low, const float *high, int count, unsigned int *mask);
+
+// * "scalar", "sse2" or "avx2", and a way to pin one for benchmarks *
+const char *bip_classify_path();
+int bip_classify_select(const char *path);
+
+#endif
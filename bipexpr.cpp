@@ -0,0 +1,352 @@
+// ****** bipexpr.cpp **********
+// WHEN expressions for BIP rules, see bipexpr.h.
+
+#include "bipexpr.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BIP_EXPR_NAME 256
+
+// * ( ), - and NOT inside each other, so a long line can not run the C stack out *
+#define BIP_EXPR_NESTING 64
+
+struct BipExprParser {
+    const char                          *p;
+    std::vector<BipExprInstruction>     *code;
+    BipExprResolve                      resolve;
+    void                                *context;
+    const char                          *error;
+    int                                 depth;
+    int                                 nesting;
+};
+
+static bool bip_expr_or(BipExprParser &parser);
+
+static void bip_expr_skip(BipExprParser &parser)
+{
+    while ((*parser.p == ' ') || (*parser.p == '\t')) {
+        parser.p++;
+    }
+}
+
+static bool bip_expr_name_char(char c)
+{
+    return isalnum((unsigned char) c) || (c == '_') || (c == '/') || (c == '.');
+}
+
+// * a keyword only matches on its own, so NOTE is a name and not NOT E *
+static bool bip_expr_word(BipExprParser &parser, const char *word)
+{
+    size_t length = strlen(word);
+
+    bip_expr_skip(parser);
+    if ((strncmp(parser.p, word, length) != 0) || bip_expr_name_char(parser.p[length])) {
+        return false;
+    }
+    parser.p += length;
+    return true;
+}
+
+static bool bip_expr_symbol(BipExprParser &parser, const char *symbol)
+{
+    size_t length = strlen(symbol);
+
+    bip_expr_skip(parser);
+    if (strncmp(parser.p, symbol, length) != 0) {
+        return false;
+    }
+    parser.p += length;
+    return true;
+}
+
+static bool bip_expr_nest(BipExprParser &parser)
+{
+    if (++parser.nesting > BIP_EXPR_NESTING) {
+        parser.error = "expression is nested too deep";
+        return false;
+    }
+    return true;
+}
+
+// * change is what the instruction does to the stack depth *
+static bool bip_expr_emit(BipExprParser &parser, int op, int change)
+{
+    BipExprInstruction instruction;
+
+    parser.depth += change;
+    if (parser.depth > BIP_EXPR_STACK) {
+        parser.error = "expression is nested too deep";
+        return false;
+    }
+    instruction.Op = (unsigned char) op;
+    instruction.Operand = -1;
+    instruction.Slot = 0;
+    instruction.Value = 0.0f;
+    parser.code->push_back(instruction);
+    return true;
+}
+
+static bool bip_expr_primary(BipExprParser &parser)
+{
+    char name[BIP_EXPR_NAME];
+    char *end;
+    size_t length = 0;
+    long index = -1;
+    int operand;
+
+    bip_expr_skip(parser);
+    if (bip_expr_symbol(parser, "(")) {
+        if (!bip_expr_nest(parser) || !bip_expr_or(parser)) {
+            return false;
+        }
+        if (!bip_expr_symbol(parser, ")")) {
+            parser.error = "missing )";
+            return false;
+        }
+        parser.nesting--;
+        return true;
+    }
+
+    // * a number running on into a letter, _ or / is a dataref, 757Avionics/... say *
+    if (isdigit((unsigned char) *parser.p) || (*parser.p == '.')) {
+        float value = (float) strtod(parser.p, &end);
+
+        if (end == parser.p) {
+            parser.error = "bad number";
+            return false;
+        }
+        if (!bip_expr_name_char(*end)) {
+            parser.p = end;
+            if (!bip_expr_emit(parser, BIP_EXPR_PUSH, 1)) {
+                return false;
+            }
+            parser.code->back().Value = value;
+            return true;
+        }
+    }
+
+    if (!bip_expr_name_char(*parser.p)) {
+        parser.error = "expected a number, a dataref or (";
+        return false;
+    }
+    while (bip_expr_name_char(parser.p[length])) {
+        if (length == BIP_EXPR_NAME - 1) {
+            parser.error = "dataref name is too long";
+            return false;
+        }
+        name[length] = parser.p[length];
+        length++;
+    }
+    name[length] = '\0';
+    parser.p += length;
+
+    // * no blank between a dataref and its [index] *
+    if (*parser.p == '[') {
+        index = strtol(parser.p + 1, &end, 10);
+        if ((end == parser.p + 1) || (*end != ']') || (index < 0)) {
+            parser.error = "bad [index] after a dataref";
+            return false;
+        }
+        parser.p = end + 1;
+    }
+
+    operand = parser.resolve(parser.context, name, (int) index, &parser.error);
+    if (operand < 0) {
+        return false;
+    }
+    if (!bip_expr_emit(parser, BIP_EXPR_LOAD, 1)) {
+        return false;
+    }
+    parser.code->back().Operand = operand;
+    return true;
+}
+
+static bool bip_expr_unary(BipExprParser &parser)
+{
+    if (bip_expr_symbol(parser, "-")) {
+        if (!bip_expr_nest(parser) || !bip_expr_unary(parser)) {
+            return false;
+        }
+        parser.nesting--;
+        return bip_expr_emit(parser, BIP_EXPR_NEG, 0);
+    }
+    return bip_expr_primary(parser);
+}
+
+static bool bip_expr_product(BipExprParser &parser)
+{
+    int op;
+
+    if (!bip_expr_unary(parser)) {
+        return false;
+    }
+    for (;;) {
+        if (bip_expr_symbol(parser, "*")) {
+            op = BIP_EXPR_MUL;
+        } else if (bip_expr_symbol(parser, "/")) {
+            op = BIP_EXPR_DIV;
+        } else {
+            return true;
+        }
+        if (!bip_expr_unary(parser) || !bip_expr_emit(parser, op, -1)) {
+            return false;
+        }
+    }
+}
+
+static bool bip_expr_sum(BipExprParser &parser)
+{
+    int op;
+
+    if (!bip_expr_product(parser)) {
+        return false;
+    }
+    for (;;) {
+        if (bip_expr_symbol(parser, "+")) {
+            op = BIP_EXPR_ADD;
+        } else if (bip_expr_symbol(parser, "-")) {
+            op = BIP_EXPR_SUB;
+        } else {
+            return true;
+        }
+        if (!bip_expr_product(parser) || !bip_expr_emit(parser, op, -1)) {
+            return false;
+        }
+    }
+}
+
+// * one comparison at most, a < b < c is an error rather than a surprise *
+static bool bip_expr_compare(BipExprParser &parser)
+{
+    int op;
+
+    if (!bip_expr_sum(parser)) {
+        return false;
+    }
+    if (bip_expr_symbol(parser, "<=")) {
+        op = BIP_EXPR_LE;
+    } else if (bip_expr_symbol(parser, ">=")) {
+        op = BIP_EXPR_GE;
+    } else if (bip_expr_symbol(parser, "==")) {
+        op = BIP_EXPR_EQ;
+    } else if (bip_expr_symbol(parser, "!=")) {
+        op = BIP_EXPR_NE;
+    } else if (bip_expr_symbol(parser, "<")) {
+        op = BIP_EXPR_LT;
+    } else if (bip_expr_symbol(parser, ">")) {
+        op = BIP_EXPR_GT;
+    } else {
+        return true;
+    }
+    return bip_expr_sum(parser) && bip_expr_emit(parser, op, -1);
+}
+
+static bool bip_expr_not(BipExprParser &parser)
+{
+    if (bip_expr_word(parser, "NOT")) {
+        if (!bip_expr_nest(parser) || !bip_expr_not(parser)) {
+            return false;
+        }
+        parser.nesting--;
+        return bip_expr_emit(parser, BIP_EXPR_NOT, 0);
+    }
+    return bip_expr_compare(parser);
+}
+
+static bool bip_expr_and(BipExprParser &parser)
+{
+    if (!bip_expr_not(parser)) {
+        return false;
+    }
+    while (bip_expr_word(parser, "AND")) {
+        if (!bip_expr_not(parser) || !bip_expr_emit(parser, BIP_EXPR_AND, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool bip_expr_or(BipExprParser &parser)
+{
+    if (!bip_expr_and(parser)) {
+        return false;
+    }
+    while (bip_expr_word(parser, "OR")) {
+        if (!bip_expr_and(parser) || !bip_expr_emit(parser, BIP_EXPR_OR, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char *bip_expr_compile(const char *text, std::vector<BipExprInstruction> &code,
+                             BipExprResolve resolve, void *context)
+{
+    BipExprParser parser;
+    size_t start = code.size();
+
+    parser.p = text;
+    parser.code = &code;
+    parser.resolve = resolve;
+    parser.context = context;
+    parser.error = NULL;
+    parser.depth = 0;
+    parser.nesting = 0;
+
+    if (bip_expr_or(parser)) {
+        bip_expr_skip(parser);
+        if (*parser.p != '\0') {
+            parser.error = "unexpected text after the expression";
+        }
+    }
+    if (parser.error == NULL) {
+        bip_expr_emit(parser, BIP_EXPR_END, 0);
+        return NULL;
+    }
+    code.resize(start);
+    return parser.error;
+}
+
+float bip_expr_run(const BipExprInstruction *code, const float *values)
+{
+    float stack[BIP_EXPR_STACK];
+    int top = -1;
+
+    for (;; code++) {
+        switch (code->Op) {
+        case BIP_EXPR_END:
+            return (top >= 0) ? stack[top] : 0.0f;
+        case BIP_EXPR_PUSH:
+            stack[++top] = code->Value;
+            break;
+        case BIP_EXPR_LOAD:
+            stack[++top] = values[code->Slot];
+            break;
+        case BIP_EXPR_NEG:
+            stack[top] = -stack[top];
+            break;
+        case BIP_EXPR_NOT:
+            stack[top] = (stack[top] == 0.0f) ? 1.0f : 0.0f;
+            break;
+        default:
+            top--;
+            switch (code->Op) {
+            case BIP_EXPR_ADD: stack[top] = stack[top] + stack[top + 1]; break;
+            case BIP_EXPR_SUB: stack[top] = stack[top] - stack[top + 1]; break;
+            case BIP_EXPR_MUL: stack[top] = stack[top] * stack[top + 1]; break;
+            case BIP_EXPR_DIV: stack[top] = stack[top] / stack[top + 1]; break;
+            case BIP_EXPR_LT:  stack[top] = (stack[top] < stack[top + 1]) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_LE:  stack[top] = (stack[top] <= stack[top + 1]) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_GT:  stack[top] = (stack[top] > stack[top + 1]) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_GE:  stack[top] = (stack[top] >= stack[top + 1]) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_EQ:  stack[top] = (stack[top] == stack[top + 1]) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_NE:  stack[top] = (stack[top] != stack[top + 1]) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_AND: stack[top] = ((stack[top] != 0.0f) && (stack[top + 1] != 0.0f)) ? 1.0f : 0.0f; break;
+            case BIP_EXPR_OR:  stack[top] = ((stack[top] != 0.0f) || (stack[top + 1] != 0.0f)) ? 1.0f : 0.0f; break;
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef BIPEXPR_H
+#define BIPEXPR_H
+
+// ****** bipexpr.h **********
+// "#SET BIP A 0 R WHEN (sim/flightmodel/engine/ENGN_N1_[0] > 20) AND
+// (sim/cockpit2/engine/indicators/oil_pressure_psi[0] < 25)" lights its
+// indicator while the expression is true, so one rule can stand in for a
+// helper plugin publishing a derived dataref.
+//
+// An expression is compiled once, when the config is read, into a small
+// stack program. Each dataref it names becomes an operand the caller
+// resolves; the caller then points every BIP_EXPR_LOAD at the slot its
+// value is fetched into, so expressions share the dataref fetches of the
+// range rules.
+//
+//   numbers, dataref and dataref[index]
+//   ( )   - (negate)   * /   + -   < <= > >= == !=   NOT   AND   OR
+//
+// listed from the tightest binding to the loosest. Comparisons and logic
+// give 1 or 0, and anything other than 0 counts as true.
+
+#include <vector>
+
+enum BipExprOp {
+    BIP_EXPR_END = 0,
+    BIP_EXPR_PUSH,      // Value
+    BIP_EXPR_LOAD,      // values[Slot]
+    BIP_EXPR_NEG,
+    BIP_EXPR_ADD,
+    BIP_EXPR_SUB,
+    BIP_EXPR_MUL,
+    BIP_EXPR_DIV,
+    BIP_EXPR_LT,
+    BIP_EXPR_LE,
+    BIP_EXPR_GT,
+    BIP_EXPR_GE,
+    BIP_EXPR_EQ,
+    BIP_EXPR_NE,
+    BIP_EXPR_NOT,
+    BIP_EXPR_AND,
+    BIP_EXPR_OR
+};
+
+struct BipExprInstruction {
+    unsigned char   Op;
+    int             Operand;    // LOAD: what resolve returned for the dataref
+    int             Slot;       // LOAD: set by the caller before the program runs
+    float           Value;      // PUSH
+};
+
+// * the deepest stack a compiled program may need *
+#define BIP_EXPR_STACK 32
+
+// * operand number for name, index is -1 without [ ], or -1 after saying why in error *
+typedef int (*BipExprResolve)(void *context, const char *name, int index, const char **error);
+
+// * appends text's program, ending in BIP_EXPR_END, to code; NULL or what is wrong with text *
+const char *bip_expr_compile(const char *text, std::vector<BipExprInstruction> &code,
+                             BipExprResolve resolve, void *context);
+
+float bip_expr_run(const BipExprInstruction *code, const float *values);
+
+#endif
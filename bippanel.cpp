@@ -35,14 +35,18 @@ BOOL APIENTRY DllMain( HANDLE hModule,
 
 #include "hidapi.h"
 #include "saitekpanels.h"
+#include "bipclassify.h"
+#include "bipexpr.h"
 
 #include <vector>
+#include <algorithm>
 
 #include <time.h>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <string.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -50,50 +54,472 @@ BOOL APIENTRY DllMain( HANDLE hModule,
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#if !IBM
+#include <pthread.h>
+#endif
 
 
 using namespace std;
 
-#define MAXTABLEELEMENTS 1000
-
 //MAXINDICATORS is the Position of indicators in one row
 #define MAXINDICATORS 8
 // ********************** Bip Panel variables ***********************
-float   LookAtThisValue;
-int     LookAtThisIntValue;
 
 //static int bipnum = 0;
-static unsigned char bipwbuf[4][10];
-static unsigned char lastbipwbuf[4][10];
+static int bippowered = 1;
 
-static int bipchange, biploop[4], res, i[4];
+static int bipchange, res;
 
+// ***************** BIP Rule Table *******************
+// Each BIP keeps its rules in a table that grows with the loaded config, so
+// the rules walked every frame sit together in a few cache lines. Dataref
+// names for the CSV debug table are kept apart, in a pool per BIP filled
+// as the config loads.
 struct  BipTableStructure
 {
-    char            Row; // A B or C
-    int             Position; // 0 tru 7
-    char            Color;  // G green R red A amber
     XPLMDataRef     DataRefToSet;
     XPLMDataTypeID  DataRefType;
     int             DataRefIndex;
-    char            WhatToDo;
     float           FloatValueToSet;
     float           FloatLimit;
-    char            CSVDebugString[512];
+    int             DebugName; // offset in the BIP's DebugPool, -1 for no name
+    int             ValueSlot; // this rule's value in the BIP's Values
+    int             Every; // ms between evaluations, 0 every turn
+    int             Program; // WHEN rule's start in the BIP's Code, -1 for a RANGE rule
+    char            Row; // A B or C
+    unsigned char   Position; // 0 tru 7
+    char            Color;  // G green R red A amber
+    char            WhatToDo;
+};
+
+// ***************** BIP Dataref Fetches *******************
+// Rules are grouped by dataref when a config is read. Every dataref is read
+// once a frame into the BIP's Values, an array dataref with one call covering all
+// the indices its rules use, so a gauge with green, amber and red ranges
+// costs one SDK call instead of three. The datarefs named in WHEN
+// expressions join the same fetches.
+struct  BipFetchStructure
+{
+    XPLMDataRef     DataRef;
+    XPLMDataTypeID  DataRefType;
+    int             FirstIndex;
+    int             Count;
+    int             ValueSlot;
+};
+
+static std::vector<int>     BipIntScratch;
+
+// * a dataref named in a WHEN expression, DataRefIndex is 0 for a scalar *
+struct  BipOperandStructure
+{
+    XPLMDataRef     DataRef;
+    XPLMDataTypeID  DataRefType;
+    int             DataRefIndex;
+};
+
+// ***************** BIP Range Classification *******************
+// The range rules of a table, in table order, with their values gathered
+// each frame next to their ranges so bip_classify() can test them all at
+// once. An indicator shows its last rule in the table, so only those rules
+// are live, and only a live rule whose result differs from the one it had
+// last frame touches the report.
+struct  BipClassifyStructure
+{
+    std::vector<int>            Rule;   // index in the BIP's Table
+    std::vector<int>            Slot;   // index in the BIP's Values
+    std::vector<float>          Value;
+    std::vector<float>          Low;
+    std::vector<float>          High;
+    std::vector<unsigned int>   Lit;
+    std::vector<unsigned int>   Last;   // Lit as it was applied
+    std::vector<unsigned int>   Live;   // the last rule of each indicator
+    bool                        Fresh;  // apply every live rule next frame
+};
+
+// ***************** BIP Refresh Tiers *******************
+// "EVERY 500ms" after a rule puts it in a tier with the other rules of that
+// period, with its own dataref fetches and ranges. A tier is only fetched
+// and classified when it is due, so a door or parking brake light read at
+// 2 Hz costs nothing on the turns in between, while rules without EVERY
+// are still looked at on every turn of their BIP.
+struct  BipTierStructure
+{
+    int                             Every;
+    double                          Due;    // panel_clock_us() of the next evaluation
+    std::vector<BipFetchStructure>  Fetches;
+    std::vector<int>                Expressions;    // WHEN rules, run into their ValueSlot after the fetch
+    BipClassifyStructure            Classify;
 };
 
-static BipTableStructure    BipTable[4][MAXTABLEELEMENTS];
+// ***************** BIP Devices *******************
+// Every BIP is found and opened in one enumeration when the plugin starts
+// and stays open until it stops. They are ordered by serial number, highest
+// first as they always were, so each keeps its D2B_config file whatever
+// order the USB stack lists them in. Everything one BIP needs lives in its
+// BipPanel, so any number of them can be connected.
+
+struct  BipPanel
+{
+    hid_device                      *Handle;
+    std::wstring                    Serial;
+    XPLMMenuID                      Menu;
+    unsigned char                   WriteBuffer[10];
+    unsigned char                   LastWriteBuffer[10];
+    int                             Loop;
+    int                             Dirty;      // an indicator changed since the last report
+    std::vector<BipTableStructure>  Table;
+    std::vector<BipTierStructure>   Tiers;
+    std::vector<float>              Values;     // every fetched value, see BipFetchStructure
+    std::vector<BipExprInstruction> Code;       // every WHEN rule's program
+    std::vector<BipOperandStructure> Operands;  // what each BIP_EXPR_LOAD in Code reads
+    std::string                     DebugPool;
+    string                          ICAO;
+    int                             LastTableElement;
+
+    BipPanel();
+};
+
+BipPanel::BipPanel()
+{
+    Handle = NULL;
+    Menu = NULL;
+    memset(WriteBuffer, 0, sizeof(WriteBuffer));
+    memset(LastWriteBuffer, 0, sizeof(LastWriteBuffer));
+    Loop = 0;
+    Dirty = 0;
+    LastTableElement = -1;
+}
+
+static std::vector<BipPanel> bippanels;
 
-static int                  LastTableElement[4] = {-1, -1, -1, -1};
 static int                  ErrorInLine = 0;
 static bool                 InSilentMode = false;
 
-static char     MenuEntries[4][50][250];
 
-static int      LastMenuEntry[4] = {0, 0, 0, 0};
 
 bool ReadConfigFile(string PlaneICAO);
 void WriteCSVTableToDisk(void);
+static void bip_csv_poll(bool wait);
+
+// * forget this BIP's rules, the table keeps its capacity for the next read *
+static void bip_table_clear(int bip)
+{
+    BipPanel &panel = bippanels[bip];
+
+    panel.Table.clear();
+    panel.DebugPool.clear();
+    panel.Code.clear();
+    panel.Operands.clear();
+    panel.LastTableElement = -1;
+}
+
+static BipTableStructure &bip_table_add(int bip)
+{
+    BipTableStructure rule;
+
+    memset(&rule, 0, sizeof(rule));
+    rule.Row = '0';
+    rule.Color = '0';
+    rule.WhatToDo = '0';
+    rule.DebugName = -1;
+    rule.Program = -1;
+
+    BipPanel &panel = bippanels[bip];
+
+    panel.Table.push_back(rule);
+    panel.LastTableElement = (int) panel.Table.size() - 1;
+    return panel.Table.back();
+}
+
+// * a run of rules on one dataref, its array elements say, shares one copy *
+static int bip_debug_name(int bip, const char *name)
+{
+    std::string &pool = bippanels[bip].DebugPool;
+    size_t last, offset = pool.size();
+
+    if (offset > 1) {
+        last = pool.rfind('\0', offset - 2);
+        last = (last == std::string::npos) ? 0 : last + 1;
+        if (strcmp(pool.c_str() + last, name) == 0) {
+            return (int) last;
+        }
+    }
+    pool.append(name);
+    pool.push_back('\0');
+    return (int) offset;
+}
+
+// ***************** BIP WHEN Rules *******************
+// "#SET BIP A 0 R WHEN <expression>" compiles the expression into the BIP's
+// Code with bipexpr.cpp. The rule then lights like a RANGE 1 TO 1 rule on
+// a value its program works out after each fetch, so it is classified and
+// flipped with the range rules.
+static int bip_expr_resolve(void *context, const char *name, int index, const char **error)
+{
+    BipPanel &panel = bippanels[*(int *) context];
+    BipOperandStructure operand;
+    int array;
+
+    operand.DataRef = XPLMFindDataRef(name);
+    if (operand.DataRef == NULL) {
+        *error = "A DataRef you want to use is not defined!";
+        return -1;
+    }
+    operand.DataRefType = XPLMGetDataRefTypes(operand.DataRef);
+    array = (operand.DataRefType == xplmType_IntArray) || (operand.DataRefType == xplmType_FloatArray);
+    if (!array && !((operand.DataRefType == xplmType_Int) || (operand.DataRefType == xplmType_Float))) {
+        *error = "A DataRef you want to use can not be read (wrong type)!";
+        return -1;
+    }
+    if (array != (index >= 0)) {
+        *error = array ? "An array DataRef needs an [index]!" : "Only an array DataRef takes an [index]!";
+        return -1;
+    }
+    operand.DataRefIndex = array ? index : 0;
+    panel.Operands.push_back(operand);
+    return (int) panel.Operands.size() - 1;
+}
+
+// * NULL once rule has its program, else what is wrong with text *
+static const char *bip_rule_expression(int bip, BipTableStructure &rule, const char *text)
+{
+    int start = (int) bippanels[bip].Code.size();
+    const char *error = bip_expr_compile(text, bippanels[bip].Code, bip_expr_resolve, &bip);
+
+    if (error != NULL) {
+        return error;
+    }
+    rule.Program = start;
+    rule.FloatValueToSet = 1.0f;
+    rule.FloatLimit = 1.0f;
+    rule.WhatToDo = 'v';
+    return NULL;
+}
+
+// * a read of ref at index for the tier, merged into an earlier read of the same ref *
+static void bip_fetch_add(std::vector<BipFetchStructure> &fetches, XPLMDataRef ref, XPLMDataTypeID type, int index)
+{
+    int array = (type == xplmType_FloatArray) || (type == xplmType_IntArray);
+    size_t f;
+
+    for (f = 0; f < fetches.size(); f++) {
+        if (fetches[f].DataRef == ref) {
+            break;
+        }
+    }
+    if (f == fetches.size()) {
+        BipFetchStructure fetch;
+
+        fetch.DataRef = ref;
+        fetch.DataRefType = type;
+        fetch.FirstIndex = array ? index : 0;
+        fetch.Count = 1;
+        fetch.ValueSlot = 0;
+        fetches.push_back(fetch);
+        return;
+    }
+    if (array) {
+        BipFetchStructure &fetch = fetches[f];
+        int last = fetch.FirstIndex + fetch.Count - 1;
+
+        if (index < fetch.FirstIndex) {
+            fetch.FirstIndex = index;
+        }
+        if (index > last) {
+            last = index;
+        }
+        fetch.Count = last - fetch.FirstIndex + 1;
+    }
+}
+
+// * where the value of ref at index lands in Values once the tier is fetched *
+static int bip_fetch_slot(const std::vector<BipFetchStructure> &fetches, XPLMDataRef ref, XPLMDataTypeID type, int index)
+{
+    size_t f;
+
+    for (f = 0; f < fetches.size(); f++) {
+        if (fetches[f].DataRef == ref) {
+            if ((type == xplmType_FloatArray) || (type == xplmType_IntArray)) {
+                return fetches[f].ValueSlot + index - fetches[f].FirstIndex;
+            }
+            return fetches[f].ValueSlot;
+        }
+    }
+    return 0;
+}
+
+// * group the tier's datarefs, their values go from slot on in Values, then one slot per WHEN result *
+static int bip_tier_fetches(int bip, BipTierStructure &tier, int slot)
+{
+    BipPanel &panel = bippanels[bip];
+    std::vector<BipFetchStructure> &fetches = tier.Fetches;
+    size_t n, f;
+    int i;
+
+    fetches.clear();
+    tier.Expressions.clear();
+    for (n = 0; n < panel.Table.size(); n++) {
+        const BipTableStructure &rule = panel.Table[n];
+
+        if ((rule.WhatToDo != 'v') || (rule.Every != tier.Every)) {
+            continue;
+        }
+        if (rule.Program < 0) {
+            bip_fetch_add(fetches, rule.DataRefToSet, rule.DataRefType, rule.DataRefIndex);
+            continue;
+        }
+        tier.Expressions.push_back((int) n);
+        for (i = rule.Program; panel.Code[i].Op != BIP_EXPR_END; i++) {
+            if (panel.Code[i].Op == BIP_EXPR_LOAD) {
+                const BipOperandStructure &operand = panel.Operands[panel.Code[i].Operand];
+
+                bip_fetch_add(fetches, operand.DataRef, operand.DataRefType, operand.DataRefIndex);
+            }
+        }
+    }
+
+    for (f = 0; f < fetches.size(); f++) {
+        fetches[f].ValueSlot = slot;
+        slot += fetches[f].Count;
+        if ((fetches[f].DataRefType == xplmType_IntArray) && (fetches[f].Count > (int) BipIntScratch.size())) {
+            BipIntScratch.resize(fetches[f].Count);
+        }
+    }
+
+    for (n = 0; n < panel.Table.size(); n++) {
+        BipTableStructure &rule = panel.Table[n];
+
+        if ((rule.WhatToDo != 'v') || (rule.Every != tier.Every)) {
+            continue;
+        }
+        if (rule.Program < 0) {
+            rule.ValueSlot = bip_fetch_slot(fetches, rule.DataRefToSet, rule.DataRefType, rule.DataRefIndex);
+            continue;
+        }
+        rule.ValueSlot = slot++;
+        for (i = rule.Program; panel.Code[i].Op != BIP_EXPR_END; i++) {
+            if (panel.Code[i].Op == BIP_EXPR_LOAD) {
+                const BipOperandStructure &operand = panel.Operands[panel.Code[i].Operand];
+
+                panel.Code[i].Slot = bip_fetch_slot(fetches, operand.DataRef, operand.DataRefType, operand.DataRefIndex);
+            }
+        }
+    }
+    return slot;
+}
+
+// * the tier's range rules in table order, padding rules have an empty range so they never light *
+static void bip_tier_classify(int bip, BipTierStructure &tier, const std::vector<char> &live)
+{
+    BipClassifyStructure &classify = tier.Classify;
+    size_t n;
+
+    classify.Rule.clear();
+    classify.Slot.clear();
+    classify.Low.clear();
+    classify.High.clear();
+    for (n = 0; n < bippanels[bip].Table.size(); n++) {
+        const BipTableStructure &rule = bippanels[bip].Table[n];
+
+        if ((rule.WhatToDo == 'v') && (rule.Every == tier.Every)) {
+            classify.Rule.push_back((int) n);
+            classify.Slot.push_back(rule.ValueSlot);
+            classify.Low.push_back(rule.FloatValueToSet);
+            classify.High.push_back(rule.FloatLimit);
+        }
+    }
+    while ((classify.Low.size() % BIP_CLASSIFY_WIDTH) != 0) {
+        classify.Low.push_back(1.0f);
+        classify.High.push_back(0.0f);
+    }
+    classify.Value.assign(classify.Low.size(), 0.0f);
+    classify.Lit.assign(BIP_CLASSIFY_WORDS(classify.Low.size()), 0);
+    classify.Last.assign(classify.Lit.size(), 0);
+    classify.Live.assign(classify.Lit.size(), 0);
+    classify.Fresh = true;
+    for (n = 0; n < classify.Rule.size(); n++) {
+        if (live[classify.Rule[n]]) {
+            classify.Live[n >> 5] |= 1u << (n & 31);
+        }
+    }
+}
+
+// * one tier per EVERY period, shortest first, with a slot in Values for every value read *
+static void bip_table_compile(int bip)
+{
+    std::vector<BipTierStructure> &tiers = bippanels[bip].Tiers;
+    std::vector<char> live(bippanels[bip].Table.size(), 0);
+    unsigned char seen[3] = {0, 0, 0};
+    size_t n, t;
+    int slot = 0;
+
+    tiers.clear();
+    for (n = 0; n < bippanels[bip].Table.size(); n++) {
+        const BipTableStructure &rule = bippanels[bip].Table[n];
+
+        if (rule.WhatToDo != 'v') {
+            continue;
+        }
+        for (t = 0; (t < tiers.size()) && (tiers[t].Every < rule.Every); t++) {
+        }
+        if ((t == tiers.size()) || (tiers[t].Every != rule.Every)) {
+            BipTierStructure tier;
+
+            tier.Every = rule.Every;
+            tier.Due = 0.0;
+            tiers.insert(tiers.begin() + t, tier);
+        }
+    }
+
+    // * walking back, the first rule seen for an indicator is the one it shows *
+    for (n = bippanels[bip].Table.size(); n-- > 0; ) {
+        const BipTableStructure &rule = bippanels[bip].Table[n];
+        int row = rule.Row - 'A';
+        unsigned char bit = (unsigned char) (1 << rule.Position);
+
+        if ((rule.WhatToDo != 'v') || (row < 0) || (row > 2) || (seen[row] & bit)) {
+            continue;
+        }
+        seen[row] |= bit;
+        live[n] = 1;
+    }
+
+    for (t = 0; t < tiers.size(); t++) {
+        slot = bip_tier_fetches(bip, tiers[t], slot);
+    }
+    bippanels[bip].Values.assign(slot, 0.0f);
+    for (t = 0; t < tiers.size(); t++) {
+        bip_tier_classify(bip, tiers[t], live);
+    }
+}
+
+static void bip_fetch_values(int bip, const BipTierStructure &tier)
+{
+    const std::vector<BipFetchStructure> &fetches = tier.Fetches;
+    size_t f;
+    int n, got;
+
+    for (f = 0; f < fetches.size(); f++) {
+        const BipFetchStructure &fetch = fetches[f];
+        float *value = &bippanels[bip].Values[fetch.ValueSlot];
+
+        if (fetch.DataRefType == xplmType_Float) {
+            *value = XPLMGetDataf(fetch.DataRef);
+        }
+        if (fetch.DataRefType == xplmType_Int) {
+            *value = (float) XPLMGetDatai(fetch.DataRef);
+        }
+        if (fetch.DataRefType == xplmType_FloatArray) {
+            XPLMGetDatavf(fetch.DataRef, value, fetch.FirstIndex, fetch.Count);
+        }
+        if (fetch.DataRefType == xplmType_IntArray) {
+            got = XPLMGetDatavi(fetch.DataRef, &BipIntScratch[0], fetch.FirstIndex, fetch.Count);
+            for (n = 0; n < got; n++) {
+                value[n] = (float) BipIntScratch[n];
+            }
+        }
+    }
+}
 
 
 void LetWidgetSay(string BipTextToDisplay)
@@ -119,40 +545,6 @@ void logMsg ( std::string message )
   LetWidgetSay(message.append(" (in line no. ").append(out).append(")"));
 }
 
-void WriteCSVTableToDisk(void)
-{
-    time_t      rawtime;
-    struct      tm * timeinfo;
-    char        CSVFileName[512];
-
-    time( &rawtime );
-    timeinfo = localtime( &rawtime );
-
-    strftime(CSVFileName, 512, "Resources/plugins/Xsaitekpanels/D2B_debug_%Y-%m-%d_%H%M%S.csv", timeinfo);
-    ofstream CSVFile(CSVFileName);
-    if (CSVFile.is_open() != true)
-    {
-        logMsg("Xdatareaf2BIP: Fatal Error: Unable to write a CSV.");
-        return;
-    }
-    CSVFile << "\"Row\",\"Position\",\"Color\",\"DataRefToSet\",\"DataRefType\",\"DataRefIndex\"\"";
-    CSVFile << "WhatToDo\",\"FloatLimit\",\"CSVDebugString\"\n";
-
-    for (int i = 0; i < MAXTABLEELEMENTS; i++)
-    {
-        CSVFile << "\"" << BipTable[0][i].Row << "\",";
-        CSVFile << "\"" << BipTable[0][i].Position << "\",";
-        CSVFile << "\"" << BipTable[0][i].Color << "\",";
-        CSVFile << "\"" << BipTable[0][i].DataRefToSet << "\",";
-        CSVFile << "\"" << BipTable[0][i].DataRefType << "\",";
-        CSVFile << "\"" << BipTable[0][i].DataRefIndex << "\",";
-        CSVFile << "\"" << BipTable[0][i].WhatToDo << "\",";
-        CSVFile << "\"" << BipTable[0][i].FloatLimit << "\",";
-        CSVFile << "\"" << BipTable[0][i].CSVDebugString << "\"\n";
-    }
-    CSVFile.close();
-}
-
 string convert_Mac_Bip_Path(string bip_in_path) {
 
     char bip_seperator_number_buffer[255] = {0};
@@ -180,694 +572,817 @@ string convert_Mac_Bip_Path(string bip_in_path) {
 
 }
 
+static bool ReadBipConfigFile(string PlaneICAO);
+
+// * every read, good or bad, leaves a table that is grouped before it is used *
 bool ReadConfigFile(string PlaneICAO)
 {
+    bool ok;
 
-  string          LineToEncrypt[4];
-  bool            CorrectICAO = true;
-  char            RowString[1];
-  int             BipPosition;
-  char            ColorString[1];
-  char            DataRefString[512];
-  XPLMDataRef     DataRefNumber;
-  XPLMDataTypeID  DataRefType;
-  float           Argument, Limit;
-  int             Index;
-  int             i, i1;
-
-  char           *bip1ConfigurationPath;
-  char           *bip2ConfigurationPath;
-  const char     *foundd2bpath, *foundd2bpath2;
-  char           buff[256];
-
-  PlaneICAO.erase(PlaneICAO.find(']')+1);
-  LetWidgetSay(PlaneICAO);
+    if ((bipnum < 0) || (bipnum >= (int) bippanels.size())) {
+        return false;
+    }
+    ok = ReadBipConfigFile(PlaneICAO);
 
-  LastMenuEntry[0] = -1;
-  LastMenuEntry[1] = -1;
+    bip_table_compile(bipnum);
+    return ok;
+}
 
-  char xpsbipacfname[512];
-  char xpsbipacfpath[512];
-  XPLMGetNthAircraftModel(0, xpsbipacfname, xpsbipacfpath);
+// ***************** BIP Config Loader *******************
+// One loader serves every BIP. The config is read into memory with a
+// single read and split into lines in place. Only "#SET BIP" lines are
+// tokenised, and each of those is tokenised once and dispatched on its
+// FROM keyword, instead of going through up to three sscanf patterns.
+#define BIPCONFIGTOKENS 16
 
-  if(strlen(xpsbipacfpath) == 0){
-    return false;
-  }
+static std::vector<char> BipConfigText;
 
-  std::string xpsbipd2b_path_name = xpsbipacfpath;
-  std::string xpsbipd2b_path_name2;
-  std::size_t pos = xpsbipd2b_path_name.find(xpsbipacfname);
-  xpsbipd2b_path_name = xpsbipd2b_path_name.substr(0, pos);
+// * D2B_config.txt for the first BIP, then D2B_config2.txt, D2B_config3.txt and on *
+static string bip_config_name(int bip)
+{
+    char name[32];
 
-  #if APL && __MACH__
-      std::string mac_converted_bip_path = convert_Mac_Bip_Path(xpsbipd2b_path_name);
-      XPLMDebugString("\nmac_converted_bip_path is\n");
-      XPLMDebugString(mac_converted_bip_path.c_str());
-      XPLMDebugString("\n");
-      xpsbipd2b_path_name = mac_converted_bip_path;
-  #endif
+    if (bip == 0) {
+        return "D2B_config.txt";
+    }
+    sprintf(name, "D2B_config%d.txt", bip + 1);
+    return name;
+}
 
-  xpsbipd2b_path_name2 = xpsbipd2b_path_name;
+// * only the first BIP has an ICAO caption *
+static XPWidgetID bip_config_widget(int bip)
+{
+    return (bip == 0) ? BipWidgetID : NULL;
+}
 
+// * the aircraft folder first, then the plugin folder *
+static bool bip_config_path(int bip, string &path)
+{
+    char xpsbipacfname[512];
+    char xpsbipacfpath[512];
 
-  if(bipnum == bipwcscmp0) {
+    XPLMGetNthAircraftModel(0, xpsbipacfname, xpsbipacfpath);
+    if (strlen(xpsbipacfpath) == 0) {
+        return false;
+    }
 
-      //sprintf(buff, "if(bipnum == bipwcscmp0) bipnum %d == bipwcscmp0 %d\n", bipnum, bipwcscmp0);
-      //XPLMDebugString(buff);
+    path = xpsbipacfpath;
+    path = path.substr(0, path.find(xpsbipacfname));
+#if APL && __MACH__
+    path = convert_Mac_Bip_Path(path);
+#endif
+    path.append(bip_config_name(bip));
+    if (ifstream(path.c_str())) {
+        return true;
+    }
 
-      bip1ConfigurationPath = "./Resources/plugins/Xsaitekpanels/D2B_config.txt";
+    path = "./Resources/plugins/Xsaitekpanels/";
+    path.append(bip_config_name(bip));
+    return ifstream(path.c_str()) ? true : false;
+}
 
-      xpsbipd2b_path_name.append("D2B_config.txt");
+// * the whole file, NUL terminated, in text *
+static bool bip_config_slurp(const string &path, std::vector<char> &text)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    long size;
 
-      //XPLMDebugString("\nThe full path for D2B_config.txt in the current aircraft folder is\n");
-      //XPLMDebugString(xpsbipd2b_path_name.c_str());
-      //XPLMDebugString("\n");
+    if (file == NULL) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return false;
+    }
+    text.resize(size + 1);
+    if ((size > 0) && (fread(&text[0], 1, size, file) != (size_t) size)) {
+        fclose(file);
+        return false;
+    }
+    text[size] = '\0';
+    fclose(file);
+    return true;
+}
 
-      std::vector<char> parse_d2b_path_name(xpsbipd2b_path_name.size() + 1);
-      std::copy(xpsbipd2b_path_name.begin(), xpsbipd2b_path_name.end(), parse_d2b_path_name.begin());
+// ***************** BIP Config Cache *******************
+// A section that loaded cleanly is saved next to its config as
+// "<config>.<ICAO>.cache", stamped with the config's size and mtime. The
+// next load for that ICAO is one read of the cache, with only the datarefs
+// looked up again by name. A changed config, a dataref that is gone or
+// has a new type, or any damage to the cache falls back to the text.
+#define BIPCACHEMAGIC   0x43423244
+#define BIPCACHEVERSION 3
 
-      std::ifstream ifile(&parse_d2b_path_name[0]);
-      if (ifile) {
-          XPLMDebugString("\nFound D2B_config.txt in the current aircraft path and it is\n");
-          XPLMDebugString(&parse_d2b_path_name[0]);
-          XPLMDebugString("\n");
-          foundd2bpath = (&parse_d2b_path_name[0]);
+struct  BipCacheHeader
+{
+    unsigned int    Magic;
+    unsigned int    Version;
+    double          ConfigTime;
+    double          ConfigSize;
+    char            ICAO[64];
+    int             Silent;     // -1 untouched, else InSilentMode after the load
+    int             Widget;     // 0 untouched, 1 #SHOW ICAO, 2 #HIDE ICAO
+    int             Rules;
+    int             Names;      // bytes of NUL terminated names after the rules
+};
 
-      } else {
-          std::ifstream ifile(bip1ConfigurationPath);
-         if (ifile) {
-             //XPLMDebugString("\nFound D2B_config.txt in the Xsaitekpanels plugin path and it is\n");
-             //XPLMDebugString(bip1ConfigurationPath);
-             //XPLMDebugString("\n");
-             foundd2bpath = bip1ConfigurationPath;
-         } else {
-             return false;
-         }
-      }
+struct  BipCacheRule
+{
+    int             Name;       // offset in the names, -1 for #RESET AUTHORITY
+    int             Expression; // Name is a WHEN expression to compile again
+    int             DataRefType;
+    int             DataRefIndex;
+    float           FloatValueToSet;
+    float           FloatLimit;
+    int             Every;
+    char            Row;
+    unsigned char   Position;
+    char            Color;
+    char            WhatToDo;
+};
 
-    ifstream ReadBipFile;
-    ReadBipFile.open(foundd2bpath);
-    if (ReadBipFile.is_open() != true)
-    {
-      logMsg("Error: Can't read D2B_config config file!");
-      return false;
-    }
-    ErrorInLine = 0;
+// * what the text load did besides the rules, kept for the cache *
+static std::vector<int>     BipCacheRuleName;
+static std::string          BipCacheNames;
+static int                  BipCacheSilent, BipCacheWidget;
+static std::vector<char>    BipCacheText;
 
-    LastTableElement[bipwcscmp0] = -1;
-    for (i = 0; i < MAXTABLEELEMENTS; i++)
-    {
-      BipTable[bipwcscmp0][i].Row = '0';
-      BipTable[bipwcscmp0][i].Position = 0;
-      BipTable[bipwcscmp0][i].Color = '0';
-      BipTable[bipwcscmp0][i].DataRefToSet = NULL;
-      BipTable[bipwcscmp0][i].DataRefType = 0;
-      BipTable[bipwcscmp0][i].DataRefIndex = 0;
-      BipTable[bipwcscmp0][i].WhatToDo = '0';
-      BipTable[bipwcscmp0][i].FloatValueToSet = 0;
-      BipTable[bipwcscmp0][i].FloatLimit = 0;
-      BipTable[bipwcscmp0][i].CSVDebugString[512] = '0';
-    }
-
-    while (getline(ReadBipFile, LineToEncrypt[0]))
-    {
+static void bip_cache_begin()
+{
+    BipCacheRuleName.clear();
+    BipCacheNames.clear();
+    BipCacheSilent = -1;
+    BipCacheWidget = 0;
+}
 
+static int bip_cache_intern(const char *name)
+{
+    int offset = (int) BipCacheNames.size();
 
-        ErrorInLine++;
-        if (LineToEncrypt[bipwcscmp0].find("#BE SILENT") == 0)
-        {
-            InSilentMode = true;
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp0].find("#BE CHATTY") == 0)
-        {
-            InSilentMode = false;
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp0].find("#SHOW ICAO") == 0)
-        {
-            XPShowWidget(BipWidgetID);
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp0].find("#HIDE ICAO") == 0)
-        {
-            XPHideWidget(BipWidgetID);
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp0].find("[") == 0)
-        {
-            if ((LineToEncrypt[bipwcscmp0].find("[DEFAULT]") == 0) || (LineToEncrypt[bipwcscmp0].find(PlaneICAO) == 0))
-            {
-                CorrectICAO = true;
-            }
-            else
-            {
-                CorrectICAO = false;
-            }
-            if ((LineToEncrypt[bipwcscmp0].find("[DEFAULT]") != 0) && (++LastMenuEntry[bipwcscmp0] < 50))
-            {
-                strcpy(MenuEntries[bipwcscmp0][LastMenuEntry[0]], LineToEncrypt[bipwcscmp0].c_str());
+    BipCacheNames.append(name);
+    BipCacheNames.push_back('\0');
+    return offset;
+}
 
-            }
-        }
-        if (!CorrectICAO) continue;
+static void bip_cache_name(const char *name)
+{
+    BipCacheRuleName.push_back((name == NULL) ? -1 : bip_cache_intern(name));
+}
 
-        if (LineToEncrypt[bipwcscmp0].find("#RESET AUTHORITY") == 0)
-        {
-            if (++LastTableElement[bipwcscmp0] >= MAXTABLEELEMENTS)
-            {
-                logMsg("Xdataref2BIP: Fatal Error: Too much code to handle!");
-                ReadBipFile.close();
-                LastTableElement[bipwcscmp0] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            BipTable[0][LastTableElement[bipwcscmp0]].WhatToDo = 'T';
-            continue;
-        }
+static bool bip_cache_string(const char *names, int size, int offset)
+{
+    return (offset >= 0) && (offset < size) && (memchr(names + offset, '\0', size - offset) != NULL);
+}
 
-        if (sscanf(LineToEncrypt[bipwcscmp0].c_str(), "#SET BIP %c %i %c FROM ARRAY %s %i RANGE %f TO %f", RowString, &BipPosition, ColorString, DataRefString, &Index, &Argument, &Limit) == 7)
-        {
-            if (++LastTableElement[0] >= MAXTABLEELEMENTS)
-            {
-                logMsg("Xdataref2BIP: Fatal Error: Too much code to handle!");
-                ReadBipFile.close();
-                LastTableElement[bipwcscmp0] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            DataRefNumber = XPLMFindDataRef(DataRefString);
-            if (DataRefNumber == NULL)
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use is not defined!");
-                ReadBipFile.close();
-                return false;
-            }
-            DataRefType = XPLMGetDataRefTypes(DataRefNumber);
-            if (!((DataRefType == xplmType_IntArray) || (DataRefType == xplmType_FloatArray)))
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use can not be read (wrong type)!");
-                ReadBipFile.close();
-                return false;
-            }
+// * the ICAO with anything a file name can not hold dropped *
+static string bip_cache_path(const string &path, const string &icao)
+{
+    string cachepath = path + ".";
+    size_t n;
 
-            if ((BipPosition >= MAXINDICATORS) || (BipPosition < 0))
-            {
-                logMsg("Xdataref2BIP: Indicator does not exist!");
-                ReadBipFile.close();
-                LastTableElement[bipwcscmp0] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].Row = *RowString;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].Position = BipPosition;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].Color = *ColorString;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].DataRefToSet = DataRefNumber;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].DataRefType = DataRefType;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].DataRefIndex = Index;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].FloatValueToSet = Argument;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].FloatLimit = Limit;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].WhatToDo = 'v';
-            //BipTable[0][LastTableElement[0]].CSVDebugString = DataRefString;
-            strcpy(BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].CSVDebugString, DataRefString);
-            continue;
-        }
-        if (sscanf(LineToEncrypt[bipwcscmp0].c_str(), "#SET BIP %c %i %c FROM DATAREF %s RANGE %f TO %f", RowString, &BipPosition, ColorString, DataRefString, &Argument, &Limit) == 6)
-        {
-            if (++LastTableElement[bipwcscmp0] >= MAXTABLEELEMENTS)
-            {
-                logMsg("Xdataref2BIP: Fatal Error: Too much code to handle!");
-                ReadBipFile.close();
-                LastTableElement[bipwcscmp0] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            DataRefNumber = XPLMFindDataRef(DataRefString);
-            if (DataRefNumber == NULL)
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use is not defined!");
-                ReadBipFile.close();
-                return false;
-            }
-            DataRefType = XPLMGetDataRefTypes(DataRefNumber);
-            if (!((DataRefType == xplmType_Int) || (DataRefType == xplmType_Float)))
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use can not be read (wrong type)!");
-                ReadBipFile.close();
-                return false;
-            }
-            if ((BipPosition >= MAXINDICATORS) || (BipPosition < 0))
-            {
-                logMsg("Xdataref2BIP: Indicator does not exist!");
-                ReadBipFile.close();
-                LastTableElement[bipwcscmp0] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].Row = *RowString;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].Position = BipPosition;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].Color = *ColorString;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].DataRefToSet = DataRefNumber;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].DataRefType = DataRefType;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].FloatValueToSet = Argument;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].FloatLimit = Limit;
-            BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].WhatToDo = 'v';
-            strcpy(BipTable[bipwcscmp0][LastTableElement[bipwcscmp0]].CSVDebugString, DataRefString);
-            continue;
+    for (n = 0; n < icao.size(); n++) {
+        if (isalnum((unsigned char) icao[n]) || (icao[n] == '-') || (icao[n] == '_')) {
+            cachepath.push_back(icao[n]);
         }
+    }
+    if (cachepath[cachepath.size() - 1] == '.') {
+        cachepath.append("ALL");
+    }
+    return cachepath + ".cache";
+}
 
+static bool bip_cache_stamp(const string &path, double *time, double *size)
+{
+    struct stat info;
 
-        if (LineToEncrypt[bipwcscmp0].find('#') == 0)
-        {
-            logMsg("Xdataref2BIP: Can't understand the line of code!");
-            ReadBipFile.close();
-            LastTableElement[bipwcscmp0] = MAXTABLEELEMENTS - 1;
-            return false;
-        }
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
     }
+    *time = (double) info.st_mtime;
+    *size = (double) info.st_size;
+    return true;
+}
 
-    ReadBipFile.close();
-    //return true;
+static void bip_cache_save(int bip, const string &path, const string &icao)
+{
+    BipCacheHeader header;
+    std::vector<BipCacheRule> rules(bippanels[bip].Table.size());
+    FILE *file;
+    size_t n;
 
-   }
+    if ((icao.size() >= sizeof(header.ICAO)) || (BipCacheRuleName.size() != bippanels[bip].Table.size())) {
+        return;
+    }
+    memset(&header, 0, sizeof(header));
+    if (!bip_cache_stamp(path, &header.ConfigTime, &header.ConfigSize)) {
+        return;
+    }
+    header.Magic = BIPCACHEMAGIC;
+    header.Version = BIPCACHEVERSION;
+    strcpy(header.ICAO, icao.c_str());
+    header.Silent = BipCacheSilent;
+    header.Widget = BipCacheWidget;
+    header.Rules = (int) rules.size();
+    header.Names = (int) BipCacheNames.size();
+
+    for (n = 0; n < rules.size(); n++) {
+        const BipTableStructure &rule = bippanels[bip].Table[n];
+
+        memset(&rules[n], 0, sizeof(rules[n]));
+        rules[n].Name = BipCacheRuleName[n];
+        rules[n].DataRefType = rule.DataRefType;
+        rules[n].DataRefIndex = rule.DataRefIndex;
+        rules[n].FloatValueToSet = rule.FloatValueToSet;
+        rules[n].FloatLimit = rule.FloatLimit;
+        rules[n].Every = rule.Every;
+        rules[n].Expression = (rule.Program >= 0);
+        rules[n].Row = rule.Row;
+        rules[n].Position = rule.Position;
+        rules[n].Color = rule.Color;
+        rules[n].WhatToDo = rule.WhatToDo;
+    }
 
-    if(bipnum == bipwcscmp1) {
-
-        //sprintf(buff, "if(bipnum == bipwcscmp1) bipnum %d == bipwcscmp1 %d\n", bipnum, bipwcscmp1);
-        //XPLMDebugString(buff);
+    // * a cache that can not be written, a read only folder say, is just skipped *
+    file = fopen(bip_cache_path(path, icao).c_str(), "wb");
+    if (file == NULL) {
+        return;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    if (!rules.empty()) {
+        fwrite(&rules[0], sizeof(BipCacheRule), rules.size(), file);
+    }
+    fwrite(BipCacheNames.data(), 1, BipCacheNames.size(), file);
+    fclose(file);
+}
 
-        bip2ConfigurationPath = "./Resources/plugins/Xsaitekpanels/D2B_config2.txt";
+static bool bip_cache_load(int bip, const string &path, const string &icao)
+{
+    const BipCacheHeader *header;
+    const BipCacheRule *rules;
+    const char *names;
+    double time, size;
+    size_t bytes;
+    int n;
+
+    if (!bip_cache_stamp(path, &time, &size) || !bip_config_slurp(bip_cache_path(path, icao), BipCacheText)) {
+        return false;
+    }
+    bytes = BipCacheText.size() - 1;
+    if (bytes < sizeof(BipCacheHeader)) {
+        return false;
+    }
+    header = (const BipCacheHeader *) &BipCacheText[0];
+    if ((header->Magic != BIPCACHEMAGIC) || (header->Version != BIPCACHEVERSION) ||
+        (header->ConfigTime != time) || (header->ConfigSize != size) ||
+        (strncmp(header->ICAO, icao.c_str(), sizeof(header->ICAO)) != 0) ||
+        (header->Rules < 0) || (header->Names < 0) ||
+        (bytes != sizeof(BipCacheHeader) + header->Rules * sizeof(BipCacheRule) + header->Names)) {
+        return false;
+    }
+    rules = (const BipCacheRule *) (&BipCacheText[0] + sizeof(BipCacheHeader));
+    names = (const char *) (rules + header->Rules);
+
+    bip_table_clear(bip);
+    for (n = 0; n < header->Rules; n++) {
+        BipTableStructure &rule = bip_table_add(bip);
+
+        rule.Row = rules[n].Row;
+        rule.Position = rules[n].Position;
+        rule.Color = rules[n].Color;
+        rule.WhatToDo = rules[n].WhatToDo;
+        rule.DataRefIndex = rules[n].DataRefIndex;
+        rule.FloatValueToSet = rules[n].FloatValueToSet;
+        rule.FloatLimit = rules[n].FloatLimit;
+        rule.Every = rules[n].Every;
+        if (rules[n].Name < 0) {
+            continue;
+        }
+        if (!bip_cache_string(names, header->Names, rules[n].Name)) {
+            bip_table_clear(bip);
+            return false;
+        }
+        if (rules[n].Expression) {
+            if (bip_rule_expression(bip, rule, names + rules[n].Name) != NULL) {
+                bip_table_clear(bip);
+                return false;
+            }
+            rule.DebugName = bip_debug_name(bip, names + rules[n].Name);
+            continue;
+        }
+        rule.DataRefToSet = XPLMFindDataRef(names + rules[n].Name);
+        rule.DataRefType = (rule.DataRefToSet == NULL) ? 0 : XPLMGetDataRefTypes(rule.DataRefToSet);
+        if (rule.DataRefType != rules[n].DataRefType) {
+            bip_table_clear(bip);
+            return false;
+        }
+        rule.DebugName = bip_debug_name(bip, names + rules[n].Name);
+    }
 
-        xpsbipd2b_path_name2.append("D2B_config2.txt");
+    if (header->Silent >= 0) {
+        InSilentMode = (header->Silent != 0);
+    }
+    if (header->Widget == 1) {
+        XPShowWidget(bip_config_widget(bip));
+    }
+    if (header->Widget == 2) {
+        XPHideWidget(bip_config_widget(bip));
+    }
+    return true;
+}
 
-        //XPLMDebugString("\nThe full path for D2B_config2.txt in the current aircraft folder is\n");
-        //XPLMDebugString(xpsbipd2b_path_name2.c_str());
-        //XPLMDebugString("\n");
+// * splits line in place on blanks, like the %s and %c of the old patterns *
+// * rest, when given, is left at what follows the last token taken *
+static int bip_tokenise(char *line, char **token, int max, char **rest)
+{
+    int count = 0;
 
-        std::vector<char> parse_d2b_path_name2(xpsbipd2b_path_name2.size() + 1);
-        std::copy(xpsbipd2b_path_name2.begin(), xpsbipd2b_path_name2.end(), parse_d2b_path_name2.begin());
+    while (count < max) {
+        while ((*line == ' ') || (*line == '\t') || (*line == '\r')) {
+            line++;
+        }
+        if (*line == '\0') {
+            break;
+        }
+        token[count++] = line;
+        while ((*line != '\0') && (*line != ' ') && (*line != '\t') && (*line != '\r')) {
+            line++;
+        }
+        if (*line != '\0') {
+            *line++ = '\0';
+        }
+    }
+    if (rest != NULL) {
+        *rest = line;
+    }
+    return count;
+}
 
-        std::ifstream ifile(&parse_d2b_path_name2[0]);
-        if (ifile) {
-            //XPLMDebugString("\nFound D2B_config2.txt in the current aircraft path and it is\n");
-            //XPLMDebugString(&parse_d2b_path_name2[0]);
-            //XPLMDebugString("\n");
-            foundd2bpath2 = (&parse_d2b_path_name2[0]);
+static bool bip_token_int(const char *token, int *value)
+{
+    char *end;
 
-        } else {
-            std::ifstream ifile(bip2ConfigurationPath);
-           if (ifile) {
-               //XPLMDebugString("\nFound D2B_config2.txt in the Xsaitekpanels plugin path and it is\n");
-               //XPLMDebugString(bip2ConfigurationPath);
-               //XPLMDebugString("\n");
-               foundd2bpath2 = bip2ConfigurationPath;
+    *value = (int) strtol(token, &end, 0);
+    return end != token;
+}
 
+static bool bip_token_float(const char *token, float *value)
+{
+    char *end;
 
-           } else {
-               return false;
-           }
-        }
+    *value = (float) strtod(token, &end);
+    return end != token;
+}
 
-      ifstream ReadBip2File;
-      ReadBip2File.open(foundd2bpath2);
+// * "500ms", or a bare 500, up to a minute *
+static bool bip_token_every(const char *token, int *value)
+{
+    char *end;
+    long ms = strtol(token, &end, 10);
 
-    if (ReadBip2File.is_open() != true)
-    {
-        logMsg("Error: Can't read D2B_config2 config file!");
+    if ((end == token) || ((*end != '\0') && (strcmp(end, "ms") != 0)) || (ms < 0) || (ms > 60000)) {
         return false;
     }
-    ErrorInLine = 0;
-
-    LastTableElement[bipwcscmp1] = -1;
-    for (i1 = 0; i1 < MAXTABLEELEMENTS; i1++)
-    {
-        BipTable[bipwcscmp1][i1].Row = '0';
-        BipTable[bipwcscmp1][i1].Position = 0;
-        BipTable[bipwcscmp1][i1].Color = '0';
-        BipTable[bipwcscmp1][i1].DataRefToSet = NULL;
-        BipTable[bipwcscmp1][i1].DataRefType = 0;
-        BipTable[bipwcscmp1][i1].DataRefIndex = 0;
-        BipTable[bipwcscmp1][i1].WhatToDo = '0';
-        BipTable[bipwcscmp1][i1].FloatValueToSet = 0;
-        BipTable[bipwcscmp1][i1].FloatLimit = 0;
-        BipTable[bipwcscmp1][i1].CSVDebugString[512] = '0';
-    }
-
-    while (getline(ReadBip2File, LineToEncrypt[bipwcscmp1]))
-    {
+    *value = (int) ms;
+    return true;
+}
 
+// * "#SET BIP %c %i %c WHEN <expression>", its EVERY is cut off the expression first *
+static int bip_config_when(int bip, char *token[], char *text)
+{
+    char *every = NULL, *at;
+    int position, ms = 0;
+    const char *error;
 
-        ErrorInLine++;
-        if (LineToEncrypt[bipwcscmp1].find("#BE SILENT") == 0)
-        {
-            InSilentMode = true;
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp1].find("#BE CHATTY") == 0)
-        {
-            InSilentMode = false;
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp1].find("#SHOW ICAO") == 0)
-        {
-            XPShowWidget(Bip2WidgetID);
-            continue;
-        }
-        if (LineToEncrypt[bipwcscmp1].find("#HIDE ICAO") == 0)
-        {
-            XPHideWidget(Bip2WidgetID);
-            continue;
+    for (at = strstr(text, "EVERY"); at != NULL; at = strstr(at + 5, "EVERY")) {
+        if (((at == text) || (at[-1] == ' ') || (at[-1] == '\t')) && ((at[5] == ' ') || (at[5] == '\t'))) {
+            every = at;
         }
-        if (LineToEncrypt[bipwcscmp1].find("[") == 0)
-        {
-            //if ((LineToEncrypt[1].find("[DEFAULT2]") == 0) || (LineToEncrypt[1].find(PlaneICAO) == 0))
-            if ((LineToEncrypt[bipwcscmp1].find("[DEFAULT]") == 0) || (LineToEncrypt[bipwcscmp1].find(PlaneICAO) == 0))
-            {
-                CorrectICAO = true;
-            }
-            else
-            {
-                CorrectICAO = false;
-            }
-            //if ((LineToEncrypt[1].find("[DEFAULT2]") != 0) && (++LastMenuEntry[1] < 50))
-            if ((LineToEncrypt[bipwcscmp1].find("[DEFAULT]") != 0) && (++LastMenuEntry[bipwcscmp1] < 50))
-            {
-                strcpy(MenuEntries[bipwcscmp1][LastMenuEntry[bipwcscmp1]], LineToEncrypt[bipwcscmp1].c_str());
+    }
+    if (every != NULL) {
+        char *time[2];
 
-            }
+        *every = '\0';
+        if ((bip_tokenise(every + 5, time, 2, NULL) != 1) || !bip_token_every(time[0], &ms)) {
+            logMsg("Xdataref2BIP: EVERY needs a time like 500ms!");
+            return -1;
         }
-        if (!CorrectICAO) continue;
+    }
+    for (at = text + strlen(text); (at > text) && ((at[-1] == ' ') || (at[-1] == '\t')); at--) {
+        at[-1] = '\0';
+    }
 
-        if (LineToEncrypt[bipwcscmp1].find("#RESET AUTHORITY") == 0)
-        {
-            if (++LastTableElement[bipwcscmp1] >= MAXTABLEELEMENTS)
-            {
-                logMsg("Xdataref2BIP: Fatal Error: Too much code to handle!");
-                ReadBip2File.close();
-                LastTableElement[bipwcscmp1] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].WhatToDo = 'T';
-            continue;
-        }
+    if (!bip_token_int(token[3], &position) || (position >= MAXINDICATORS) || (position < 0)) {
+        logMsg("Xdataref2BIP: Indicator does not exist!");
+        return -1;
+    }
 
-        if (sscanf(LineToEncrypt[bipwcscmp1].c_str(), "#SET BIP %c %i %c FROM ARRAY %s %i RANGE %f TO %f", RowString, &BipPosition, ColorString, DataRefString, &Index, &Argument, &Limit) == 7)
-        {
-            if (++LastTableElement[bipwcscmp1] >= MAXTABLEELEMENTS)
-            {
-                logMsg("Xdataref2BIP: Fatal Error: Too much code to handle!");
-                ReadBip2File.close();
-                LastTableElement[bipwcscmp1] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            DataRefNumber = XPLMFindDataRef(DataRefString);
-            if (DataRefNumber == NULL)
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use is not defined!");
-                ReadBip2File.close();
-                return false;
-            }
-            DataRefType = XPLMGetDataRefTypes(DataRefNumber);
-            if (!((DataRefType == xplmType_IntArray) || (DataRefType == xplmType_FloatArray)))
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use can not be read (wrong type)!");
-                ReadBip2File.close();
-                return false;
-            }
+    BipTableStructure &rule = bip_table_add(bip);
+
+    rule.Row = token[2][0];
+    rule.Position = position;
+    rule.Color = token[4][0];
+    rule.Every = ms;
+    error = bip_rule_expression(bip, rule, text);
+    if (error != NULL) {
+        bippanels[bip].Table.pop_back();
+        bippanels[bip].LastTableElement--;
+        logMsg(string("Xdataref2BIP: ") + error);
+        return -1;
+    }
+    rule.DebugName = bip_debug_name(bip, text);
+    bip_cache_name(text);
+    return 1;
+}
 
-            if ((BipPosition >= MAXINDICATORS) || (BipPosition < 0))
-            {
-                logMsg("Xdataref2BIP: Indicator does not exist!");
-                ReadBip2File.close();
-                LastTableElement[bipwcscmp1] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].Row = *RowString;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].Position = BipPosition;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].Color = *ColorString;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].DataRefToSet = DataRefNumber;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].DataRefType = DataRefType;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].DataRefIndex = Index;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].FloatValueToSet = Argument;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].FloatLimit = Limit;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].WhatToDo = 'v';
-            strcpy(BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].CSVDebugString, DataRefString);
-            continue;
+// "#SET BIP %c %i %c FROM DATAREF %s RANGE %f TO %f" or "#SET BIP %c %i %c FROM ARRAY %s %i RANGE %f TO %f"
+// either may end in "EVERY %ims" to be looked at no more often than that
+// * 1 for a rule, 0 for a line that is not one, -1 after reporting a bad rule *
+static int bip_config_rule(int bip, char *line)
+{
+    char *token[BIPCONFIGTOKENS];
+    char *rest;
+    int count = bip_tokenise(line, token, 6, &rest);
+    int array, position, index = 0, next, every = 0;
+    float low, high;
+    XPLMDataRef ref;
+    XPLMDataTypeID type;
+
+    if ((count == 6) && (strcmp(token[0], "#SET") == 0) && (strcmp(token[1], "BIP") == 0) &&
+        (strcmp(token[5], "WHEN") == 0) && (token[2][1] == '\0') && (token[4][1] == '\0')) {
+        return bip_config_when(bip, token, rest);
+    }
+    count += bip_tokenise(rest, token + count, BIPCONFIGTOKENS - count, NULL);
+    if ((count < 12) || (strcmp(token[0], "#SET") != 0) || (strcmp(token[1], "BIP") != 0) ||
+        (strcmp(token[5], "FROM") != 0) || (token[2][1] != '\0') || (token[4][1] != '\0') ||
+        !bip_token_int(token[3], &position)) {
+        return 0;
+    }
+    if (strcmp(token[6], "ARRAY") == 0) {
+        array = 1;
+        if ((count < 13) || !bip_token_int(token[8], &index)) {
+            return 0;
         }
-        if (sscanf(LineToEncrypt[bipwcscmp1].c_str(), "#SET BIP %c %i %c FROM DATAREF %s RANGE %f TO %f", RowString, &BipPosition, ColorString, DataRefString, &Argument, &Limit) == 6)
-        {
-            if (++LastTableElement[bipwcscmp1] >= MAXTABLEELEMENTS)
-            {
-                logMsg("Xdataref2BIP: Fatal Error: Too much code to handle!");
-                ReadBip2File.close();
-                LastTableElement[bipwcscmp1] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            DataRefNumber = XPLMFindDataRef(DataRefString);
-            if (DataRefNumber == NULL)
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use is not defined!");
-                ReadBip2File.close();
-                return false;
-            }
-            DataRefType = XPLMGetDataRefTypes(DataRefNumber);
-            if (!((DataRefType == xplmType_Int) || (DataRefType == xplmType_Float)))
-            {
-                logMsg("Xdataref2BIP: A DataRef you want to use can not be read (wrong type)!");
-                ReadBip2File.close();
-                return false;
-            }
-            if ((BipPosition >= MAXINDICATORS) || (BipPosition < 0))
-            {
-                logMsg("Xdataref2BIP: Indicator does not exist!");
-                ReadBip2File.close();
-                LastTableElement[bipwcscmp1] = MAXTABLEELEMENTS - 1;
-                return false;
-            }
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].Row = *RowString;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].Position = BipPosition;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].Color = *ColorString;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].DataRefToSet = DataRefNumber;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].DataRefType = DataRefType;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].FloatValueToSet = Argument;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].FloatLimit = Limit;
-            BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].WhatToDo = 'v';
-            strcpy(BipTable[bipwcscmp1][LastTableElement[bipwcscmp1]].CSVDebugString, DataRefString);
-            continue;
+        next = 9;
+    } else if (strcmp(token[6], "DATAREF") == 0) {
+        array = 0;
+        next = 8;
+    } else {
+        return 0;
+    }
+    if ((strcmp(token[next], "RANGE") != 0) || !bip_token_float(token[next + 1], &low) ||
+        (strcmp(token[next + 2], "TO") != 0) || !bip_token_float(token[next + 3], &high)) {
+        return 0;
+    }
+    if ((count > next + 4) && (strcmp(token[next + 4], "EVERY") == 0)) {
+        if ((count < next + 6) || !bip_token_every(token[next + 5], &every)) {
+            logMsg("Xdataref2BIP: EVERY needs a time like 500ms!");
+            return -1;
         }
+    }
 
+    ref = XPLMFindDataRef(token[7]);
+    if (ref == NULL) {
+        logMsg("Xdataref2BIP: A DataRef you want to use is not defined!");
+        return -1;
+    }
+    type = XPLMGetDataRefTypes(ref);
+    if (array ? !((type == xplmType_IntArray) || (type == xplmType_FloatArray))
+              : !((type == xplmType_Int) || (type == xplmType_Float))) {
+        logMsg("Xdataref2BIP: A DataRef you want to use can not be read (wrong type)!");
+        return -1;
+    }
+    if ((position >= MAXINDICATORS) || (position < 0)) {
+        logMsg("Xdataref2BIP: Indicator does not exist!");
+        return -1;
+    }
 
-        if (LineToEncrypt[bipwcscmp1].find('#') == 0)
-        {
-            logMsg("Xdataref2BIP: Can't understand the line of code!");
-            ReadBip2File.close();
-            LastTableElement[bipwcscmp1] = MAXTABLEELEMENTS - 1;
-            return false;
-        }
+    BipTableStructure &rule = bip_table_add(bip);
+
+    rule.Row = token[2][0];
+    rule.Position = position;
+    rule.Color = token[4][0];
+    rule.DataRefToSet = ref;
+    rule.DataRefType = type;
+    rule.DataRefIndex = index;
+    rule.FloatValueToSet = low;
+    rule.FloatLimit = high;
+    rule.WhatToDo = 'v';
+    rule.Every = every;
+    rule.DebugName = bip_debug_name(bip, token[7]);
+    bip_cache_name(token[7]);
+    return 1;
+}
+
+static bool ReadBipConfigFile(string PlaneICAO)
+{
+  bool            CorrectICAO = true;
+  int             bip = bipnum;
+  string          path;
+  char            *line, *end;
+  double          start = panel_clock_us();
+  char            loadbuf[600];
 
+  PlaneICAO.erase(PlaneICAO.find(']')+1);
+  LetWidgetSay(PlaneICAO);
+  bippanels[bip].ICAO = PlaneICAO;
+  if (!bip_config_path(bip, path)) {
+    return false;
+  }
+  if (bip_cache_load(bip, path, PlaneICAO)) {
+    sprintf(loadbuf, "Xsaitekpanels: BIP %d loaded %d rules from the %s cache in %.2f ms\n",
+            bip + 1, (int) bippanels[bip].Table.size(), bip_config_name(bip).c_str(), (panel_clock_us() - start) / 1000.0);
+    XPLMDebugString(loadbuf);
+    return true;
+  }
+  if (!bip_config_slurp(path, BipConfigText)) {
+    logMsg(string("Error: Can't read ") + bip_config_name(bip) + " config file!");
+    return false;
+  }
+  ErrorInLine = 0;
+  bip_table_clear(bip);
+  bip_cache_begin();
+
+  for (line = &BipConfigText[0]; *line != '\0'; line = end) {
+    end = strchr(line, '\n');
+    if (end == NULL) {
+      end = line + strlen(line);
+    } else {
+      *end++ = '\0';
+    }
+    if ((line[0] != '\0') && (line[strlen(line) - 1] == '\r')) {
+      line[strlen(line) - 1] = '\0';
     }
 
-    ReadBip2File.close();
-    //return true;
+    ErrorInLine++;
+    if (strncmp(line, "#BE SILENT", 10) == 0) {
+      InSilentMode = true;
+      BipCacheSilent = 1;
+      continue;
+    }
+    if (strncmp(line, "#BE CHATTY", 10) == 0) {
+      InSilentMode = false;
+      BipCacheSilent = 0;
+      continue;
+    }
+    if (strncmp(line, "#SHOW ICAO", 10) == 0) {
+      XPShowWidget(bip_config_widget(bip));
+      BipCacheWidget = 1;
+      continue;
+    }
+    if (strncmp(line, "#HIDE ICAO", 10) == 0) {
+      XPHideWidget(bip_config_widget(bip));
+      BipCacheWidget = 2;
+      continue;
+    }
+    if (line[0] == '[') {
+      CorrectICAO = (strncmp(line, "[DEFAULT]", 9) == 0) || (strncmp(line, PlaneICAO.c_str(), PlaneICAO.size()) == 0);
+    }
+    if (!CorrectICAO) continue;
+
+    if (strncmp(line, "#RESET AUTHORITY", 16) == 0) {
+      bip_table_add(bip).WhatToDo = 'T';
+      bip_cache_name(NULL);
+      continue;
+    }
 
-   }
+    switch (bip_config_rule(bip, line)) {
+    case 1:
+      continue;
+    case -1:
+      return false;
+    }
 
+    if (line[0] == '#') {
+      logMsg("Xdataref2BIP: Can't understand the line of code!");
+      return false;
+    }
+  }
 
+  sprintf(loadbuf, "Xsaitekpanels: BIP %d loaded %d lines, %d rules from %.400s in %.2f ms\n",
+          bip + 1, ErrorInLine, (int) bippanels[bip].Table.size(), path.c_str(), (panel_clock_us() - start) / 1000.0);
+  XPLMDebugString(loadbuf);
+  bip_cache_save(bip, path, PlaneICAO);
 
 return true;
 }
 
-void process_bip_menu()
+// * the items every BIP menu has, the ICAO sections are picked with [BIP_TEST] *
+static void process_bip_menu(XPLMMenuID menu)
 
 {
 
-    if(bipnum == bipwcscmp0) {
+      XPLMClearAllMenuItems(menu);
+      XPLMAppendMenuItem(menu, "[DEFAULT]", (void *) "[DEFAULT]", 1);
+      XPLMAppendMenuItem(menu, "Write a CSV Table for debugging", (void *) "<<CSV>>", 1);
+      XPLMAppendMenuSeparator(menu);
+      XPLMAppendMenuItem(menu, "[BIP_TEST]", (void *) "[BIP_TEST]", 1);
 
-      XPLMClearAllMenuItems(BipMenuId);
-      XPLMAppendMenuItem(BipMenuId, "[DEFAULT]", (void *) "[DEFAULT]", 1);
-      XPLMAppendMenuItem(BipMenuId, "Write a CSV Table for debugging", (void *) "<<CSV>>", 1);
-      XPLMAppendMenuSeparator(BipMenuId);
-      //XPLMAppendMenuItem(BipMenuId, MenuEntries[0][LastMenuEntry[0]], (void *) MenuEntries[0][LastMenuEntry[0]], 1);
-      XPLMAppendMenuItem(BipMenuId, "[BIP_TEST]", (void *) "[BIP_TEST]", 1);
+    return;
+
+}
+
+// * serials compare the way wcscmp did, so the highest comes first *
+struct BipFound
+{
+    std::wstring    Serial;
+    std::string     Path;
 
+    bool operator<(const BipFound &other) const { return Serial > other.Serial; }
+};
+
+int bip_panels_open()
+{
+    struct hid_device_info *devs, *dev;
+    std::vector<BipFound> found;
+    size_t n;
+
+    devs = hid_enumerate(0x6a3, 0xb4e);
+    for (dev = devs; dev != NULL; dev = dev->next) {
+        BipFound bip;
+
+        bip.Serial = (dev->serial_number != NULL) ? dev->serial_number : L"";
+        bip.Path = dev->path;
+        found.push_back(bip);
     }
+    hid_free_enumeration(devs);
+    std::sort(found.begin(), found.end());
+
+    bippanels.clear();
+    bippanels.reserve(found.size());
+    for (n = 0; n < found.size(); n++) {
+        hid_device *handle = hid_open_path(found[n].Path.c_str());
 
-    if(bipnum == bipwcscmp1) {
+        if (handle == NULL) {
+            continue;
+        }
+        bippanels.push_back(BipPanel());
 
-        XPLMClearAllMenuItems(Bip2MenuId);
-        XPLMAppendMenuItem(Bip2MenuId, "[DEFAULT]", (void *) "[DEFAULT]", 1);
-        XPLMAppendMenuItem(Bip2MenuId, "Write a CSV Table for debugging", (void *) "<<CSV>>", 1);
-        XPLMAppendMenuSeparator(Bip2MenuId);
-        //XPLMAppendMenuItem(Bip2MenuId, MenuEntries[1][LastMenuEntry[1]], (void *) MenuEntries[1][LastMenuEntry[1]], 1);
-        XPLMAppendMenuItem(Bip2MenuId, "[BIP_TEST]", (void *) "[BIP_TEST]", 1);
+        BipPanel &panel = bippanels.back();
 
+        panel.Handle = handle;
+        panel.Serial = found[n].Serial;
+        panel.WriteBuffer[0] = 0xb2; // 0xb2 Report ID for brightness
+        panel.WriteBuffer[1] = 100;  // Set brightness to 100%
+        res = hid_send_feature_report(panel.Handle, panel.WriteBuffer, 10);
     }
+    return (int) bippanels.size();
+}
 
-    return;
+// * "Bip", "Bip2", "Bip3" and on, each reporting BIP_MENU_REF plus its number *
+void bip_panels_menus(XPLMMenuID parent, XPLMMenuHandler_f handler)
+{
+    char name[32];
+    size_t n;
+    int item;
 
+    for (n = 0; n < bippanels.size(); n++) {
+        if (n == 0) {
+            strcpy(name, "Bip");
+        } else {
+            sprintf(name, "Bip%d", (int) n + 1);
+        }
+        item = XPLMAppendMenuItem(parent, name, NULL, 1);
+        bippanels[n].Menu = XPLMCreateMenu(name, parent, item, handler, (void *) (intptr_t) (BIP_MENU_REF + n));
+        process_bip_menu(bippanels[n].Menu);
+    }
 }
 
-void process_bip_what_to_do_v()
+// * blank every BIP before letting it go *
+void bip_panels_close()
+{
+    size_t n;
+
+    bip_csv_poll(true);
 
+    for (n = 0; n < bippanels.size(); n++) {
+        BipPanel &panel = bippanels[n];
+
+        memset(panel.WriteBuffer, 0, sizeof(panel.WriteBuffer));
+        panel.WriteBuffer[0] = 0xb8;  //0xb8 Report ID to display
+        res = hid_send_feature_report(panel.Handle, panel.WriteBuffer, 10);
+        hid_close(panel.Handle);
+        if (panel.Menu != NULL) {
+            XPLMDestroyMenu(panel.Menu);
+        }
+    }
+    bippanels.clear();
+}
+
+// * row A B C is green byte 1 2 3 and red byte 4 5 6, amber lights both, 0 is off *
+static void bip_set_indicator(int bip, const BipTableStructure &rule, char color)
 {
+    unsigned char *wbuf = bippanels[bip].WriteBuffer;
+    unsigned char bit = (unsigned char) (1 << rule.Position);
+    int green;
+
+    if (rule.Row == 'A') {
+        green = 1;
+    } else if (rule.Row == 'B') {
+        green = 2;
+    } else if (rule.Row == 'C') {
+        green = 3;
+    } else {
+        return;
+    }
 
-    for (i[bipnum] = 0; i[bipnum] <= LastTableElement[bipnum]; i[bipnum]++) {
+    if (color == 'G') {
+        wbuf[green] |= bit, wbuf[green + 3] &= ~bit;
+    }
+    if (color == 'R') {
+        wbuf[green] &= ~bit, wbuf[green + 3] |= bit;
+    }
+    if (color == 'A') {
+        wbuf[green] |= bit, wbuf[green + 3] |= bit;
+    }
+    if (color == 0) {
+        wbuf[green] &= ~bit, wbuf[green + 3] &= ~bit;
+    }
+}
 
-        if (BipTable[bipnum][i[bipnum]].WhatToDo == 'v') {
-            // "#SET BIP %c %i %c FROM DATAREF %s RANGE %f TO %f" or "#SET BIP %s %i %s FROM ARRAY %s %i RANGE %f TO %f""
-            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_Float) LookAtThisValue = XPLMGetDataf(BipTable[bipnum][i[bipnum]].DataRefToSet);
-            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_Int) LookAtThisValue = (float) XPLMGetDatai(BipTable[bipnum][i[bipnum]].DataRefToSet);
-            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_FloatArray) XPLMGetDatavf(BipTable[bipnum][i[bipnum]].DataRefToSet, &LookAtThisValue, BipTable[bipnum][i[bipnum]].DataRefIndex, 1);
-            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_IntArray) {
-                XPLMGetDatavi(BipTable[bipnum][i[bipnum]].DataRefToSet, &LookAtThisIntValue, BipTable[bipnum][i[bipnum]].DataRefIndex, 1);
-                LookAtThisValue = (float) LookAtThisIntValue;
-            }
-            if ((LookAtThisValue >= BipTable[bipnum][i[bipnum]].FloatValueToSet) && (LookAtThisValue <= BipTable[bipnum][i[bipnum]].FloatLimit)) {
-
-                //printf("********************************  ON   **************************************\n");
-                if (BipTable[bipnum][i[bipnum]].Row == 'A') {
-                    if (BipTable[bipnum][i[bipnum]].Color == 'G') {
-                        // Make BipTable[i].Position position Top Row Green
-                        bipwbuf[bipnum][1] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                    if (BipTable[bipnum][i[bipnum]].Color == 'R') {
-                        // Make BipTable[i].Position position Top Row Red
-                        bipwbuf[bipnum][1] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                    if (BipTable[bipnum][i[bipnum]].Color == 'A') {
-                        // Make BipTable[i].Position position Top Row Amber
-                        bipwbuf[bipnum][1] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }    for (i[bipnum] = 0; i[bipnum] <= LastTableElement[bipnum]; i[bipnum]++) {
-
-                        if (BipTable[bipnum][i[bipnum]].WhatToDo == 'v') {
-                            // "#SET BIP %c %i %c FROM DATAREF %s RANGE %f TO %f" or "#SET BIP %s %i %s FROM ARRAY %s %i RANGE %f TO %f""
-                            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_Float) LookAtThisValue = XPLMGetDataf(BipTable[bipnum][i[bipnum]].DataRefToSet);
-                            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_Int) LookAtThisValue = (float) XPLMGetDatai(BipTable[bipnum][i[bipnum]].DataRefToSet);
-                            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_FloatArray) XPLMGetDatavf(BipTable[bipnum][i[bipnum]].DataRefToSet, &LookAtThisValue, BipTable[bipnum][i[bipnum]].DataRefIndex, 1);
-                            if (BipTable[bipnum][i[bipnum]].DataRefType == xplmType_IntArray) {
-                                XPLMGetDatavi(BipTable[bipnum][i[bipnum]].DataRefToSet, &LookAtThisIntValue, BipTable[bipnum][i[bipnum]].DataRefIndex, 1);
-                                LookAtThisValue = (float) LookAtThisIntValue;
-                            }
-                            if ((LookAtThisValue >= BipTable[bipnum][i[bipnum]].FloatValueToSet) && (LookAtThisValue <= BipTable[bipnum][i[bipnum]].FloatLimit)) {
-
-                                //printf("********************************  ON   **************************************\n");
-                                if (BipTable[bipnum][i[bipnum]].Row == 'A') {
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'G') {
-                                        // Make BipTable[i].Position position Top Row Green
-                                        bipwbuf[bipnum][1] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'R') {
-                                        // Make BipTable[i].Position position Top Row Red
-                                        bipwbuf[bipnum][1] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'A') {
-                                        // Make BipTable[i].Position position Top Row Amber
-                                        bipwbuf[bipnum][1] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                }
-
-                                if (BipTable[bipnum][i[bipnum]].Row == 'B') {
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'G') {
-                                        // Make BipTable[i].Position position Middle Row Green
-                                        bipwbuf[bipnum][2] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'R') {
-                                        // Make BipTable[i].Position position Middle Row Red
-                                        bipwbuf[bipnum][2] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'A') {
-                                        // Make BipTable[i].Position position Middle Row Amber
-                                        bipwbuf[bipnum][2] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                }
-
-                                if (BipTable[bipnum][i[bipnum]].Row == 'C') {
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'G') {
-                                        // Make BipTable[i].Position position Bottom Row Green
-                                        bipwbuf[bipnum][3] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'R') {
-                                        // Make BipTable[i].Position position Bottom Row Red
-                                        bipwbuf[bipnum][3] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                    if (BipTable[bipnum][i[bipnum]].Color == 'A') {
-                                        // Make BipTable[i].Position position Bottom Row Amber
-                                        bipwbuf[bipnum][3] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                                    }
-                                }
-                            }
-
-                            else {
-                                //printf("**********************   OFF   *********************************\n");
-                                if (BipTable[bipnum][i[bipnum]].Row == 'A') {
-                                    // Make BipTable[i].Position position Top Row Off
-                                    bipwbuf[bipnum][1] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                                }
-                                if (BipTable[bipnum][i[bipnum]].Row == 'B') {
-                                    // Make BipTable[i].Position position Middle Row Off
-                                    bipwbuf[bipnum][2] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                                }
-                                if (BipTable[bipnum][i[bipnum]].Row == 'C')  {
-                                    // Make BipTable[i].Position position Bottom Row Off
-                                    bipwbuf[bipnum][3] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                                }
-
-
-                            }
-
-                        }
-
-                    }
-                }
-
-                if (BipTable[bipnum][i[bipnum]].Row == 'B') {
-                    if (BipTable[bipnum][i[bipnum]].Color == 'G') {
-                        // Make BipTable[i].Position position Middle Row Green
-                        bipwbuf[bipnum][2] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                    if (BipTable[bipnum][i[bipnum]].Color == 'R') {
-                        // Make BipTable[i].Position position Middle Row Red
-                        bipwbuf[bipnum][2] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                    if (BipTable[bipnum][i[bipnum]].Color == 'A') {
-                        // Make BipTable[i].Position position Middle Row Amber
-                        bipwbuf[bipnum][2] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                }
-
-                if (BipTable[bipnum][i[bipnum]].Row == 'C') {
-                    if (BipTable[bipnum][i[bipnum]].Color == 'G') {
-                        // Make BipTable[i].Position position Bottom Row Green
-                        bipwbuf[bipnum][3] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                    if (BipTable[bipnum][i[bipnum]].Color == 'R') {
-                        // Make BipTable[i].Position position Bottom Row Red
-                        bipwbuf[bipnum][3] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                    if (BipTable[bipnum][i[bipnum]].Color == 'A') {
-                        // Make BipTable[i].Position position Bottom Row Amber
-                        bipwbuf[bipnum][3] |= (1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] |= (1<<(BipTable[bipnum][i[bipnum]].Position));
-                    }
-                }
-            }
+static int bip_lowest_bit(unsigned int word)
+{
+    int bit = 0;
 
-            else {
-                //printf("**********************   OFF   *********************************\n");
-                if (BipTable[bipnum][i[bipnum]].Row == 'A') {
-                    // Make BipTable[i].Position position Top Row Off
-                    bipwbuf[bipnum][1] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][4] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                }
-                if (BipTable[bipnum][i[bipnum]].Row == 'B') {
-                    // Make BipTable[i].Position position Middle Row Off
-                    bipwbuf[bipnum][2] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][5] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                }
-                if (BipTable[bipnum][i[bipnum]].Row == 'C')  {
-                    // Make BipTable[i].Position position Bottom Row Off
-                    bipwbuf[bipnum][3] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position)), bipwbuf[bipnum][6] &= ~(1<<(BipTable[bipnum][i[bipnum]].Position));
-                }
+    while ((word & 1u) == 0) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+}
 
+static void bip_tier_evaluate(int bip, BipTierStructure &tier)
+{
+    BipClassifyStructure &classify = tier.Classify;
+    int count = (int) classify.Rule.size();
+    int words = BIP_CLASSIFY_WORDS(count);
+    int n, word;
+    unsigned int flipped;
+
+    bip_fetch_values(bip, tier);
+    for (n = 0; n < (int) tier.Expressions.size(); n++) {
+        const BipTableStructure &rule = bippanels[bip].Table[tier.Expressions[n]];
+        float *values = &bippanels[bip].Values[0];
+
+        values[rule.ValueSlot] = (bip_expr_run(&bippanels[bip].Code[rule.Program], values) != 0.0f) ? 1.0f : 0.0f;
+    }
+    for (n = 0; n < count; n++) {
+        classify.Value[n] = bippanels[bip].Values[classify.Slot[n]];
+    }
+    bip_classify(&classify.Value[0], &classify.Low[0], &classify.High[0], (int) classify.Value.size(), &classify.Lit[0]);
 
+    // * live rules each own an indicator, so the flips can go in any order *
+    for (word = 0; word < words; word++) {
+        flipped = classify.Lit[word] ^ classify.Last[word];
+        if (classify.Fresh) {
+            flipped = ~0u;
+        }
+        flipped &= classify.Live[word];
+        classify.Last[word] = classify.Lit[word];
+        while (flipped != 0) {
+            n = (word << 5) + bip_lowest_bit(flipped);
+            flipped &= flipped - 1;
+            if (n >= count) {
+                break;
             }
+            const BipTableStructure &rule = bippanels[bip].Table[classify.Rule[n]];
 
+            bip_set_indicator(bip, rule, (classify.Lit[word] & (1u << (n & 31))) ? rule.Color : 0);
+            bippanels[bip].Dirty = 1;
         }
+    }
+    classify.Fresh = false;
+}
+
+void process_bip_what_to_do_v()
 
+{
+    std::vector<BipTierStructure> &tiers = bippanels[bipnum].Tiers;
+    double now;
+    size_t t;
+
+    if (tiers.empty()) {
+        return;
     }
 
+    now = panel_clock_us();
+    for (t = 0; t < tiers.size(); t++) {
+        BipTierStructure &tier = tiers[t];
+
+        if (!tier.Classify.Fresh && (now < tier.Due)) {
+            continue;
+        }
+        bip_tier_evaluate(bipnum, tier);
+        // * a fresh tier waits a share of its period less, so tiers of related
+        // * periods do not all come due on the same turn *
+        if (tier.Due == 0.0) {
+            tier.Due = now + tier.Every * 1000.0 * (t + 1) / (tiers.size() + 1);
+        } else {
+            tier.Due = now + tier.Every * 1000.0;
+        }
+    }
 
  return;
 
@@ -875,42 +1390,71 @@ void process_bip_what_to_do_v()
 
 
 // ***** BIP Panel Process  *******
+// ***************** Bus Power *******************
+// Every BIP goes dark once when the battery goes off. When it comes back
+// the last sent report is forgotten, so each BIP is rewritten on its next turn.
+void process_bip_power(int state)
+{
+    unsigned char blank[10];
+    int on = ((state & BUS_POWER_BATTERY) != 0);
+    int n;
+
+    if (on == bippowered) {
+        return;
+    }
+    bippowered = on;
+
+    memset(blank, 0, sizeof(blank));
+    blank[0] = 0xb8;  //0xb8 Report ID to display
+    for (n = 0; n < (int) bippanels.size(); n++) {
+        BipPanel &panel = bippanels[n];
+
+        if (!bippowered) {
+            res = hid_send_feature_report(panel.Handle, blank, 10);
+            memcpy(panel.LastWriteBuffer, blank, 10);
+        } else {
+            memset(panel.LastWriteBuffer, 0, 10);
+            panel.Dirty = 1;
+        }
+    }
+}
+
 void process_bip_panel()
 
 {
+    if (bippanels.empty()) {
+      return;
+    }
+    bip_csv_poll(false);
+    if (bipnum >= (int) bippanels.size()) {
+      bipnum = 0;
+    }
 
+    BipPanel &panel = bippanels[bipnum];
 
-    if (biploop[bipnum] < 2) {
+    if (panel.Loop < 2) {
       // Clear Display on first loop
-      bipwbuf[bipnum][0] = 0xb8;  //0xb8 Report ID to display
-      bipwbuf[bipnum][1] = 0, bipwbuf[bipnum][2] = 0, bipwbuf[bipnum][3] = 0;
-      bipwbuf[bipnum][4] = 0, bipwbuf[bipnum][5] = 0, bipwbuf[bipnum][6] = 0;
-      res = hid_send_feature_report(biphandle[bipnum], bipwbuf[bipnum], 10);
-      biploop[bipnum]++;
+      panel.WriteBuffer[0] = 0xb8;  //0xb8 Report ID to display
+      panel.WriteBuffer[1] = 0, panel.WriteBuffer[2] = 0, panel.WriteBuffer[3] = 0;
+      panel.WriteBuffer[4] = 0, panel.WriteBuffer[5] = 0, panel.WriteBuffer[6] = 0;
+      res = hid_send_feature_report(panel.Handle, panel.WriteBuffer, 10);
+      panel.Loop++;
+      for (size_t t = 0; t < panel.Tiers.size(); t++) {
+          panel.Tiers[t].Classify.Fresh = true;
+      }
     }
 
 
-    process_bip_menu();
     process_bip_what_to_do_v();
 
 
     // Trying to only write on changes to improve FPS impact
-    if(biploop[bipnum] == 2) {
-        bipchange = memcmp(bipwbuf[bipnum], lastbipwbuf[bipnum], 10);
-      if (bipchange == 0) {
-      }
+    if((panel.Loop == 2) && panel.Dirty && bippowered) {
+        panel.Dirty = 0;
+        bipchange = memcmp(panel.WriteBuffer, panel.LastWriteBuffer, 10);
       if (bipchange != 0) {
-        if (XPLMGetDatai(BatPwrOn) == 1) {
-            res = hid_send_feature_report(biphandle[bipnum], bipwbuf[bipnum], 10);
-            memcpy(lastbipwbuf[bipnum], bipwbuf[bipnum], 10);
-        }
-      }
-      if (XPLMGetDatai(BatPwrOn) == 0) {
-            bipwbuf[bipnum][0] = 0xb8;  //0xb8 Report ID to display
-            bipwbuf[bipnum][1] = 0, bipwbuf[bipnum][2] = 0, bipwbuf[bipnum][3] = 0;
-            bipwbuf[bipnum][4] = 0, bipwbuf[bipnum][5] = 0, bipwbuf[bipnum][6] = 0;
-            res = hid_send_feature_report(biphandle[bipnum], bipwbuf[bipnum], 10);
-            memcpy(lastbipwbuf[bipnum], bipwbuf[bipnum], 10);
+            res = hid_send_feature_report(panel.Handle, panel.WriteBuffer, 10);
+            memcpy(panel.LastWriteBuffer, panel.WriteBuffer, 10);
       }
   }
 
@@ -919,9 +1463,258 @@ void process_bip_panel()
 
   bipnum++;
 
-  if (bipnum == bipcnt) {
+  if (bipnum >= (int) bippanels.size()) {
     bipnum = 0;
   }
 
   return;
 }
+
+// ***************** BIP CSV Debug Table *******************
+// "Write a CSV Table for debugging" copies every BIP's rules, with the
+// value each one last saw and whether it is in range, into a job on the
+// main thread. A worker thread formats the job into one buffer and writes
+// it with a single fwrite, so the sim does not wait on the disk. The
+// worker never calls the SDK. process_bip_panel() picks up the result and
+// reports it on a later frame.
+struct  BipCSVRow
+{
+    int             Bip;
+    char            Row;
+    int             Position;
+    char            Color;
+    char            WhatToDo;
+    void            *DataRefToSet;
+    int             DataRefType;
+    int             DataRefIndex;
+    float           FloatValueToSet;
+    float           FloatLimit;
+    int             Every;
+    float           Value;
+    int             Lit;
+    std::string     Name;
+};
+
+#if IBM
+typedef LONG        BipCSVFlag;
+#define bip_csv_set_done(job)   InterlockedExchange(&(job)->Done, 1)
+#define bip_csv_is_done(job)    (InterlockedCompareExchange(&(job)->Done, 0, 0) != 0)
+#else
+typedef int         BipCSVFlag;
+#define bip_csv_set_done(job)   __sync_lock_test_and_set(&(job)->Done, 1)
+#define bip_csv_is_done(job)    (__sync_fetch_and_add(&(job)->Done, 0) != 0)
+#endif
+
+struct  BipCSVJob
+{
+    std::string             Path;
+    std::vector<BipCSVRow>  Rows;
+    bool                    Written;
+    BipCSVFlag              Done;
+};
+
+// * the job being written, only the main thread starts, joins and frees it *
+static BipCSVJob    *BipCSV = NULL;
+static bool         BipCSVThreaded = false;
+static bool         BipCSVQueued = false;
+#if IBM
+static HANDLE       BipCSVThread = NULL;
+#else
+static pthread_t    BipCSVThread;
+#endif
+
+static void bip_csv_quoted(std::string &out, const char *text)
+{
+    out.push_back('"');
+    for (; *text != '\0'; text++) {
+        if (*text == '"') {
+            out.push_back('"');
+        }
+        out.push_back(*text);
+    }
+    out.push_back('"');
+}
+
+static void bip_csv_write(BipCSVJob *job)
+{
+    std::string out;
+    char fields[512];
+    size_t n;
+    FILE *file;
+
+    out.reserve(128 * (job->Rows.size() + 1));
+    out.append("\"BIP\",\"Row\",\"Position\",\"Color\",\"WhatToDo\",\"DataRefToSet\",\"DataRefType\",\"DataRefIndex\",");
+    out.append("\"FloatValueToSet\",\"FloatLimit\",\"Every\",\"Value\",\"Lit\",\"CSVDebugString\"\n");
+    for (n = 0; n < job->Rows.size(); n++) {
+        const BipCSVRow &row = job->Rows[n];
+
+        sprintf(fields, "\"%d\",\"%c\",\"%d\",\"%c\",\"%c\",\"%p\",\"%d\",\"%d\",\"%g\",\"%g\",\"%d\",\"%g\",\"%d\",",
+                row.Bip + 1, row.Row, row.Position, row.Color, row.WhatToDo, row.DataRefToSet, row.DataRefType,
+                row.DataRefIndex, row.FloatValueToSet, row.FloatLimit, row.Every, row.Value, row.Lit);
+        out.append(fields);
+        bip_csv_quoted(out, row.Name.c_str());
+        out.push_back('\n');
+    }
+
+    job->Written = false;
+    file = fopen(job->Path.c_str(), "wb");
+    if (file != NULL) {
+        job->Written = (fwrite(out.data(), 1, out.size(), file) == out.size());
+        job->Written = (fclose(file) == 0) && job->Written;
+    }
+    bip_csv_set_done(job);
+}
+
+#if IBM
+static DWORD WINAPI bip_csv_thread(LPVOID job)
+{
+    bip_csv_write((BipCSVJob *) job);
+    return 0;
+}
+#else
+static void *bip_csv_thread(void *job)
+{
+    bip_csv_write((BipCSVJob *) job);
+    return NULL;
+}
+#endif
+
+// * written to the disk on its own thread, or right here if no thread can be had *
+static void bip_csv_start(BipCSVJob *job)
+{
+    BipCSV = job;
+#if IBM
+    BipCSVThread = CreateThread(NULL, 0, bip_csv_thread, job, 0, NULL);
+    BipCSVThreaded = (BipCSVThread != NULL);
+#else
+    BipCSVThreaded = (pthread_create(&BipCSVThread, NULL, bip_csv_thread, job) == 0);
+#endif
+    if (!BipCSVThreaded) {
+        bip_csv_write(job);
+    }
+}
+
+static void bip_csv_join()
+{
+    if (!BipCSVThreaded) {
+        return;
+    }
+#if IBM
+    WaitForSingleObject(BipCSVThread, INFINITE);
+    CloseHandle(BipCSVThread);
+    BipCSVThread = NULL;
+#else
+    pthread_join(BipCSVThread, NULL);
+#endif
+    BipCSVThreaded = false;
+}
+
+// * X-System/Resources/plugins/Xsaitekpanels/D2B_debug_<time>.csv *
+static string bip_csv_path()
+{
+    static char lastname[64];
+    static int repeat;
+    char system[512];
+    char name[64];
+    time_t rawtime;
+    string path;
+
+    time(&rawtime);
+    strftime(name, sizeof(name), "D2B_debug_%Y-%m-%d_%H%M%S", localtime(&rawtime));
+    if (strcmp(name, lastname) == 0) {
+        sprintf(name + strlen(name), "_%d", ++repeat);
+    } else {
+        strcpy(lastname, name);
+        repeat = 1;
+    }
+
+    XPLMGetSystemPath(system);
+    path = system;
+#if APL && __MACH__
+    path = convert_Mac_Bip_Path(path);
+#endif
+    return path + "Resources/plugins/Xsaitekpanels/" + name + ".csv";
+}
+
+// * the rules as the BIPs last evaluated them, copied on the main thread *
+static void bip_csv_begin()
+{
+    BipCSVJob *job = new BipCSVJob;
+    size_t n, t;
+    int bip;
+
+    job->Path = bip_csv_path();
+    job->Written = false;
+    job->Done = 0;
+    for (bip = 0; bip < (int) bippanels.size(); bip++) {
+        const BipPanel &panel = bippanels[bip];
+        std::vector<char> lit(panel.Table.size(), 0);
+
+        for (t = 0; t < panel.Tiers.size(); t++) {
+            const BipClassifyStructure &classify = panel.Tiers[t].Classify;
+
+            for (n = 0; n < classify.Rule.size(); n++) {
+                lit[classify.Rule[n]] = (classify.Lit[n >> 5] >> (n & 31)) & 1;
+            }
+        }
+        for (n = 0; n < panel.Table.size(); n++) {
+            const BipTableStructure &rule = panel.Table[n];
+            BipCSVRow row;
+
+            row.Bip = bip;
+            row.Row = rule.Row;
+            row.Position = rule.Position;
+            row.Color = rule.Color;
+            row.WhatToDo = rule.WhatToDo;
+            row.DataRefToSet = rule.DataRefToSet;
+            row.DataRefType = rule.DataRefType;
+            row.DataRefIndex = rule.DataRefIndex;
+            row.FloatValueToSet = rule.FloatValueToSet;
+            row.FloatLimit = rule.FloatLimit;
+            row.Every = rule.Every;
+            row.Value = (rule.WhatToDo == 'v') ? panel.Values[rule.ValueSlot] : 0.0f;
+            row.Lit = lit[n];
+            if (rule.DebugName >= 0) {
+                row.Name = panel.DebugPool.c_str() + rule.DebugName;
+            }
+            job->Rows.push_back(row);
+        }
+    }
+    bip_csv_start(job);
+}
+
+// * report a finished table and start one asked for meanwhile, or with wait *
+// * finish the one still being written and forget any asked for *
+static void bip_csv_poll(bool wait)
+{
+    char report[600];
+
+    if ((BipCSV == NULL) || (!wait && !bip_csv_is_done(BipCSV))) {
+        return;
+    }
+    bip_csv_join();
+    if (BipCSV->Written) {
+        sprintf(report, "Xsaitekpanels: wrote %d BIP rules to %.500s\n", (int) BipCSV->Rows.size(), BipCSV->Path.c_str());
+        XPLMDebugString(report);
+    } else {
+        logMsg("Xdatareaf2BIP: Fatal Error: Unable to write a CSV.");
+    }
+    delete BipCSV;
+    BipCSV = NULL;
+
+    if (BipCSVQueued && !wait) {
+        bip_csv_begin();
+    }
+    BipCSVQueued = false;
+}
+
+// * a table still being written is not waited for, the new one follows it *
+void WriteCSVTableToDisk(void)
+{
+    bip_csv_poll(false);
+    if (BipCSV != NULL) {
+        BipCSVQueued = true;
+        return;
+    }
+    bip_csv_begin();
+}
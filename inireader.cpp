@@ -64,6 +64,7 @@ void cleanupIniReader()
         for (int x = 0; x <= i; x++)
         {
                 delete iniItem[x];
+                iniItem[x] = NULL;
         }
 
         i = 0;
@@ -126,6 +127,27 @@ int getOptionToInt(std::string key)
         return 0;
 }
 
+int getOptionCount()
+{
+        //Check to see if anything got parsed?
+        if (i <= 0)
+        {
+                return 0;
+        }
+
+        return i + 1;
+}
+
+const std::string &getOptionKey(int n)
+{
+        return iniItem[n]->key;
+}
+
+const std::string &getOptionValue(int n)
+{
+        return iniItem[n]->value;
+}
+
 std::string parseOptionName(std::string value)
 {
         size_t found;
@@ -52,6 +52,16 @@ int getOptionToInt(std::string key);
  */
 const char *getOptionToChar(std::string key);
 
+/**
+ * Walk the parsed items in file order without copying them
+ *
+ * @return   int The number of parsed items, 0 if nothing was parsed
+ * @note     getOptionKey and getOptionValue take 0 to getOptionCount() - 1
+ */
+int getOptionCount();
+const std::string &getOptionKey(int n);
+const std::string &getOptionValue(int n);
+
 std::string parseOptionName(std::string value);
 std::string parseOptionValue(std::string value);
 std::string trim(std::string s);
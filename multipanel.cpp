@@ -4,6 +4,7 @@
 
 #include "XPLMUtilities.h"
 #include "XPLMDataAccess.h"
+#include "XPLMProcessing.h"
 
 #include "saitekpanels.h"
 
@@ -13,11 +14,11 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <string.h>
-
-#define testbit(x, y)  ( ( ((const char*)&(x))[(y)>>3] & 0x80 >> ((y)&0x07)) >> (7-((y)&0x07) ) )
+#include <math.h>
 
 // ********************** Multi Panel variables ***********************
-static int multinowrite = 0, lastmultiseldis = 0;
+static unsigned int lastmultihash = 0;
+static float lastmultiwrite = 0, multikeepalive = 5.0;
 static int mulres, multires;
 
 static int multimul = 10;
@@ -28,35 +29,445 @@ static int appushed = 0;
 static int lastappos = 0;
 static int aploop = 0;
 
-static int upapalt, upapvs, upapas, upaphdg, upapcrs, upapcrs2, neg;
+static int upapalt, upapvs, upapas, upaphdg, upapcrs, neg;
 static int flashcnt = 0, flashon = 0;
 
 static int altdbncinc = 0, altdbncdec = 0, vsdbncinc = 0, vsdbncdec = 0;
 static int iasdbncinc = 0, iasdbncdec = 0, hdgdbncinc = 0, hdgdbncdec = 0;
 static int crsdbncinc = 0, crsdbncdec = 0; 
 
-static float upapaltf, upapvsf, upapasf, upaphdgf, upapcrsf, upapcrsf2, rhdgf;
+static float upapaltf, upapvsf, upapasf, rhdgf;
 
 static int multiaactv, multiadig1, multiarem1, multiadig2, multiarem2;
 static int multiadig3, multiarem3, multiadig4, multiarem4, multiadig5;
 static int multibstby, multibdig1, multibdig2, multibrem2;
 static int multibdig3, multibrem3, multibdig4, multibrem4, multibdig5;  
-static int btnleds = 0, lastbtnleds = 0, multiseldis = 1;
-
-static int ALT_SWITCH = 7, VS_SWITCH = 6;
-static int IAS_SWITCH = 5, HDG_SWITCH = 4;
-static int CRS_SWITCH = 3, AUTO_THROTTLE_SWITCH = 8;
-static int AP_MASTER_BUTTON = 0, HDG_BUTTON = 15;
-static int NAV_BUTTON = 14, IAS_BUTTON = 13;
-static int ALT_BUTTON = 12, VS_BUTTON = 11;
-static int APR_BUTTON = 10, REV_BUTTON = 9;
-static int FLAPS_UP_SWITCH = 23, FLAPS_DN_SWITCH = 22;
-static int TRIM_WHEEL_UP = 20, TRIM_WHEEL_DN = 21;
-static int ADJUSTMENT_UP = 2, ADJUSTMENT_DN = 1;
+static int btnleds = 0, multiseldis = 1;
+static int multipowered = 1;
+
+// ***** Autopilot status bitfield, low byte engaged, high byte armed *****
+static unsigned int apstatebits = 0;
+// ***** Armed modes lit for flashon 0 / 1 (VS flashes out of phase) *****
+static const unsigned char multiarmedmask[2] = {0x20, 0xDF};
+
+// * report bit names, see panelreport.h for the numbering *
+static const int ALT_SWITCH = 7, VS_SWITCH = 6;
+static const int IAS_SWITCH = 5, HDG_SWITCH = 4;
+static const int CRS_SWITCH = 3, AUTO_THROTTLE_SWITCH = 8;
+static const int AP_MASTER_BUTTON = 0, HDG_BUTTON = 15;
+static const int NAV_BUTTON = 14, IAS_BUTTON = 13;
+static const int ALT_BUTTON = 12, VS_BUTTON = 11;
+static const int APR_BUTTON = 10, REV_BUTTON = 9;
+static const int FLAPS_UP_SWITCH = 23, FLAPS_DN_SWITCH = 22;
+static const int TRIM_WHEEL_UP = 20, TRIM_WHEEL_DN = 21;
+static const int ADJUSTMENT_UP = 2, ADJUSTMENT_DN = 1;
 
 static unsigned char multibuf[4];
+static panel_word multiword = 0;
 static unsigned char multiwbuf[13];
 
+// ***************** Fixed Point Angle *******************
+// Heading and course bugs in hundredths of a degree, always kept in
+// [0, 36000) so detents add and subtract modulo a full turn.
+struct FixedAngle {
+    int cdeg;
+
+    static FixedAngle from_float(float deg)
+    {
+        FixedAngle a;
+        a.cdeg = 0;
+        return a.add_cdeg((int)floorf((deg * 100.0f) + 0.5f));
+    }
+
+    FixedAngle add_cdeg(int delta) const
+    {
+        FixedAngle a;
+        a.cdeg = (cdeg + delta) % 36000;
+        if (a.cdeg < 0) {
+            a.cdeg += 36000;
+        }
+        return a;
+    }
+
+    FixedAngle add(int deg) const { return add_cdeg(deg * 100); }
+    float to_float() const { return cdeg / 100.0f; }
+    int whole() const { return cdeg / 100; }
+};
+
+// ***** HDG/CRS bugs are read once, detents accumulate, one write per frame *****
+static FixedAngle multihdg, multicrs;
+static int hdgaccum = 0, crsaccum = 0;
+static int hdgsampled = 0, crssampled = 0;
+static XPLMDataRef multicrsref = NULL;
+
+
+// ***************** Autopilot Status Bitfield *******************
+// Low byte holds the engaged modes and high byte the armed modes, both in
+// btnleds bit order.
+void multi_ap_pack(int led, int status)
+{
+    if (status == 2) {
+        apstatebits |= (1<<led);
+    } else if (status == 1) {
+        apstatebits |= (1<<(led + 8));
+    }
+}
+
+// ***************** Aircraft Autopilot Adapters *******************
+// Each supported aircraft family specialises MultiAdapter. Its handler table
+// is installed once when the aircraft changes, so the per-report handlers
+// never test which aircraft is loaded. To add an aircraft, add an id,
+// specialise MultiAdapter and list its table in multiadapters.
+
+enum {
+    MULTI_AC_DEFAULT = 0,
+    MULTI_AC_X737,
+    MULTI_AC_COUNT
+};
+
+struct MultiAdapterTable {
+    void (*alt_set)(float alt);
+    void (*vs_step)(int dir, int fast);
+    void (*ias_step)(int dir, int fast);
+    void (*hdg_step)(int dir, int fast);
+    void (*hdg_commit)();
+    void (*athr_set)(int on);
+    void (*ap_master_press)();
+    void (*hdg_press)();
+    void (*nav_press)();
+    void (*ias_press)();
+    void (*alt_press)();
+    void (*vs_press)();
+    void (*apr_press)();
+    void (*ap_state)();
+    unsigned char mastermask;   // LEDS held dark while AP master is off
+};
+
+template <int Aircraft> struct MultiAdapter;
+
+// ****** Default X-Plane autopilot ******
+template <> struct MultiAdapter<MULTI_AC_DEFAULT> {
+
+    static void alt_set(float alt)
+    {
+        XPLMSetDataf(ApAlt, alt);
+    }
+
+    static void vs_step(int dir, int fast)
+    {
+        if (fast) {
+            upapvs = upapvs + (dir * 100 * multimul);
+        } else if ((dir > 0) && (apvsupremap == 1)) {
+            XPLMCommandOnce(ApVsUpRemapableCmd);
+        } else if ((dir < 0) && (apvsdnremap == 1)) {
+            XPLMCommandOnce(ApVsDnRemapableCmd);
+        } else {
+            upapvs = upapvs + (dir * 100);
+        }
+    }
+
+    static void ias_step(int dir, int fast)
+    {
+        n = fast ? multimul : 1;
+        while (n>0) {
+            if (XPLMGetDatai(AirspeedIsMach) == 1) {
+                XPLMSetDataf(Airspeed, XPLMGetDataf(Airspeed) + (dir * 0.01));
+            } else {
+                upapas = upapas + dir;
+            }
+            --n;
+        }
+    }
+
+    static void hdg_step(int dir, int fast)
+    {
+        hdgaccum = hdgaccum + (dir * (fast ? multimul : 1));
+    }
+
+    static void hdg_commit()
+    {
+        if (hdgaccum != 0) {
+            multihdg = multihdg.add(hdgaccum);
+            hdgaccum = 0;
+            XPLMSetDataf(ApHdg, multihdg.to_float());
+        }
+    }
+
+    static void athr_set(int on)
+    {
+        XPLMSetDatai(ApAutThr, on);
+    }
+
+    static void ap_master_press()
+    {
+        switch(XPLMGetDatai(ApMstrStat)){
+          case 0:
+            XPLMSetDatai(ApMstrStat, 1);
+            appushed = 1;
+            lastappos = 1;
+            break;
+          case 1:
+            if (lastappos == 1){
+              XPLMSetDatai(ApMstrStat, 2);
+              appushed = 1;
+            }
+            if (lastappos == 2){
+              XPLMSetDatai(ApMstrStat, 0);
+              appushed = 1;
+            }
+            break;
+          case 2:
+            XPLMSetDatai(ApMstrStat, 1);
+            appushed = 1;
+            lastappos = 2;
+            break;
+        }
+    }
+
+    static void hdg_press()
+    {
+        if(xpanelsfnbutton == 1) {
+            rhdgf = XPLMGetDataf(MHdg);
+            XPLMSetDataf(ApHdg, rhdgf);
+        }
+        if(xpanelsfnbutton == 0) {
+            XPLMCommandOnce(ApHdgBtn);
+            lastappos = 1;
+        }
+    }
+
+    static void nav_press()
+    {
+        if (navbuttonremap == 1) {
+            XPLMCommandOnce(NavButtonRemapableCmd);
+            lastappos = 1;
+            return;
+        }
+        if(xpanelsfnbutton == 1) {
+            xpanelscrstoggle = !xpanelscrstoggle;
+        }
+        if(xpanelsfnbutton == 0) {
+            XPLMCommandOnce(ApNavBtn);
+            lastappos = 1;
+        }
+    }
+
+    static void ias_press()
+    {
+        if(xpanelsfnbutton == 1) {
+            if (XPLMGetDatai(AirspeedIsMach) == 1) {
+                XPLMSetDatai(AirspeedIsMach, 0);
+            } else {
+                XPLMSetDatai(AirspeedIsMach, 1);
+            }
+        }
+        if(xpanelsfnbutton == 0) {
+            XPLMCommandOnce(ApIasBtn);
+            lastappos = 1;
+        }
+    }
+
+    static void alt_press()
+    {
+        XPLMCommandOnce(ApAltBtn);
+        lastappos = 1;
+    }
+
+    static void vs_press()
+    {
+        XPLMCommandOnce(ApVsBtn);
+        lastappos = 1;
+    }
+
+    static void apr_press()
+    {
+        if (aprbuttonremap == 1) {
+            XPLMCommandOnce(AprButtonRemapableCmd);
+            lastappos = 1;
+            return;
+        }
+        if(xpanelsfnbutton == 1) {
+            rhdgf = XPLMGetDataf(MHdg);
+            XPLMSetDataf(ApCrs, rhdgf);
+        }
+        if(xpanelsfnbutton == 0) {
+            XPLMCommandOnce(ApAprBtn);
+            lastappos = 1;
+        }
+    }
+
+    static void ap_state()
+    {
+        multi_ap_pack(0, XPLMGetDatai(ApMstrStat));
+        multi_ap_pack(1, XPLMGetDatai(ApHdgStat));
+        multi_ap_pack(2, XPLMGetDatai(ApNavStat));
+        multi_ap_pack(3, XPLMGetDatai(ApIasStat));
+        multi_ap_pack(4, XPLMGetDatai(ApAltStat));
+        multi_ap_pack(5, XPLMGetDatai(ApVsStat));
+        multi_ap_pack(6, XPLMGetDatai(ApAprStat));
+    }
+
+    // * HDG and ALT follow the AP master *
+    static const unsigned char mastermask = 0x12;
+};
+
+// ****** x737 MCP ******
+template <> struct MultiAdapter<MULTI_AC_X737> {
+
+    static void alt_set(float alt)
+    {
+        XPLMSetDataf(x737mcp_alt, alt);
+    }
+
+    static void vs_step(int dir, int fast)
+    {
+        if (dir > 0) {
+            XPLMCommandOnce(fast ? x737mcp_vvi_up_fast : x737mcp_vvi_up);
+        } else {
+            XPLMCommandOnce(fast ? x737mcp_vvi_down_fast : x737mcp_vvi_down);
+        }
+    }
+
+    static void ias_step(int dir, int fast)
+    {
+        if (dir > 0) {
+            XPLMCommandOnce(fast ? x737mcp_spd_up_fast : x737mcp_spd_up);
+        } else {
+            XPLMCommandOnce(fast ? x737mcp_spd_down_fast : x737mcp_spd_down);
+        }
+    }
+
+    static void hdg_step(int dir, int fast)
+    {
+        if (dir > 0) {
+            XPLMCommandOnce(fast ? x737mcp_hdg_up_fast : x737mcp_hdg_up);
+        } else {
+            XPLMCommandOnce(fast ? x737mcp_hdg_down_fast : x737mcp_hdg_down);
+        }
+    }
+
+    // * the x737 owns its heading bug, nothing to write back *
+    static void hdg_commit()
+    {
+    }
+
+    static void athr_set(int on)
+    {
+        XPLMSetDatai(x737athr_armed, on);
+    }
+
+    static void ap_master_press()
+    {
+        XPLMCommandOnce(x737mcp_cmd_a_toggle);
+        appushed = 1;
+        lastappos = 1;
+    }
+
+    static void hdg_press()
+    {
+        XPLMCommandOnce(x737mcp_hdg_toggle);
+        lastappos = 1;
+    }
+
+    static void nav_press()
+    {
+        switch (XPLMGetDatai(HsiSelector)) {
+            case 0:
+            case 1:
+                XPLMCommandOnce(x737mcp_vorloc_toggle);
+                break;
+            case 2:
+                XPLMCommandOnce(x737mcp_lnav_toggle);
+                break;
+        }
+        lastappos = 1;
+    }
+
+    static void ias_press()
+    {
+        if (xpanelsfnbutton == 1) {
+            XPLMCommandOnce(x737mcp_spd_changeover);
+        }
+        if (xpanelsfnbutton == 0) {
+            XPLMCommandOnce(x737mcp_lvlchange_toggle);
+            lastappos = 1;
+        }
+    }
+
+    static void alt_press()
+    {
+        XPLMCommandOnce(x737mcp_alt_toggle);
+        lastappos = 1;
+    }
+
+    static void vs_press()
+    {
+        XPLMCommandOnce(x737mcp_vs_toggle);
+        lastappos = 1;
+    }
+
+    static void apr_press()
+    {
+        XPLMCommandOnce(x737mcp_app_toggle);
+        lastappos = 1;
+    }
+
+    // * glareshield LEDs are on/off, armed comes from the afds refs *
+    static void ap_state()
+    {
+        multi_ap_pack(0, XPLMGetDatai(x737mcp_cmd_a_led) ? 2 : 0);
+        multi_ap_pack(1, XPLMGetDatai(x737mcp_hdg_led) ? 2 : 0);
+        if (XPLMGetDatai(HsiSelector) == 2) {
+            multi_ap_pack(2, XPLMGetDatai(x737mcp_lnav) ? 2 : (XPLMGetDatai(x737mcp_lnav_armed) ? 1 : 0));
+        } else {
+            multi_ap_pack(2, XPLMGetDatai(x737mcp_vorloc_led) ? 2 : (XPLMGetDatai(x737mcp_vorloc_armed) ? 1 : 0));
+        }
+        multi_ap_pack(3, XPLMGetDatai(x737mcp_lvlchange_led) ? 2 : 0);
+        multi_ap_pack(4, XPLMGetDatai(x737mcp_alt_led) ? 2 : 0);
+        multi_ap_pack(5, XPLMGetDatai(x737mcp_vvi_led) ? 2 : (XPLMGetDatai(x737mcp_vvi_armed_led) ? 1 : 0));
+        multi_ap_pack(6, XPLMGetDatai(x737mcp_app_led) ? 2 : 0);
+    }
+
+    static const unsigned char mastermask = 0x00;
+};
+
+template <int Aircraft> struct MultiAdapterInstall {
+    static const MultiAdapterTable table;
+};
+
+template <int Aircraft> const MultiAdapterTable MultiAdapterInstall<Aircraft>::table = {
+    MultiAdapter<Aircraft>::alt_set,
+    MultiAdapter<Aircraft>::vs_step,
+    MultiAdapter<Aircraft>::ias_step,
+    MultiAdapter<Aircraft>::hdg_step,
+    MultiAdapter<Aircraft>::hdg_commit,
+    MultiAdapter<Aircraft>::athr_set,
+    MultiAdapter<Aircraft>::ap_master_press,
+    MultiAdapter<Aircraft>::hdg_press,
+    MultiAdapter<Aircraft>::nav_press,
+    MultiAdapter<Aircraft>::ias_press,
+    MultiAdapter<Aircraft>::alt_press,
+    MultiAdapter<Aircraft>::vs_press,
+    MultiAdapter<Aircraft>::apr_press,
+    MultiAdapter<Aircraft>::ap_state,
+    MultiAdapter<Aircraft>::mastermask
+};
+
+static const MultiAdapterTable *multiadapters[MULTI_AC_COUNT] = {
+    &MultiAdapterInstall<MULTI_AC_DEFAULT>::table,
+    &MultiAdapterInstall<MULTI_AC_X737>::table
+};
+
+static const MultiAdapterTable *multiac = &MultiAdapterInstall<MULTI_AC_DEFAULT>::table;
+
+// ***** Called from the flight loop when the loaded aircraft family changes *****
+void process_multi_select_aircraft(int aircraft)
+{
+    if ((aircraft < 0) || (aircraft >= MULTI_AC_COUNT)) {
+        aircraft = MULTI_AC_DEFAULT;
+    }
+    multiac = multiadapters[aircraft];
+}
 
 void process_multi_menu()
 {
@@ -141,11 +552,11 @@ void process_multi_display()
 void process_alt_switch()
 {
 
-	if(testbit(multibuf,ALT_SWITCH)) {
+	if(panel_test(multiword, ALT_SWITCH)) {
           multiseldis = 1;
           upapaltf = XPLMGetDataf(ApAlt);
           upapalt = (int)(upapaltf);
-	  if(testbit(multibuf,ADJUSTMENT_UP)) {
+	  if(panel_test(multiword, ADJUSTMENT_UP)) {
             altdbncinc++;
             if (altdbncinc > multispeed) {
                  if(xpanelsfnbutton == 1) {
@@ -164,7 +575,7 @@ void process_alt_switch()
 
           }
 
-          if(testbit(multibuf,ADJUSTMENT_DN)) {
+          if(panel_test(multiword, ADJUSTMENT_DN)) {
              altdbncdec++;
              if (altdbncdec > multispeed) {
                  if(xpanelsfnbutton == 1) {
@@ -193,12 +604,7 @@ void process_alt_switch()
           }
 
           upapaltf = upapalt;
-
-          if (loaded737 == 1) {
-              XPLMSetDataf(x737mcp_alt, upapaltf);
-          } else {
-              XPLMSetDataf(ApAlt, upapaltf);
-          }
+          multiac->alt_set(upapaltf);
 
           upapvsf = XPLMGetDataf(ApVs);
           upapvs = (int)(upapvsf);
@@ -217,67 +623,22 @@ void process_alt_switch()
 void process_vs_switch()
 {
 
-   if(testbit(multibuf,VS_SWITCH)) {
+   if(panel_test(multiword, VS_SWITCH)) {
       multiseldis = 1;
       upapvsf = XPLMGetDataf(ApVs);
       upapvs = (int)(upapvsf);
-	  if(testbit(multibuf,ADJUSTMENT_UP)) {
+	  if(panel_test(multiword, ADJUSTMENT_UP)) {
          vsdbncinc++;
          if (vsdbncinc > multispeed) {
-            n = multimul;
-            if (xpanelsfnbutton == 1) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_vvi_up_fast);
-               } else {
-                   while (n>0) {
-                       //XPLMCommandOnce(ApVsUp);
-                       upapvs = upapvs + 100;
-                       --n;
-                   }
-                }
-                vsdbncinc = 0;
-            }
-
-            if (xpanelsfnbutton == 0) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_vvi_up);
-               } else if (apvsupremap == 1) {
-                  XPLMCommandOnce(ApVsUpRemapableCmd);
-                } else {
-                   //XPLMCommandOnce(ApVsUp);
-                   upapvs = upapvs + 100;
-                }
-                vsdbncinc = 0;
-            }
+            multiac->vs_step(1, xpanelsfnbutton == 1);
+            vsdbncinc = 0;
          }
 	  }
-	  if(testbit(multibuf,ADJUSTMENT_DN)) {
+	  if(panel_test(multiword, ADJUSTMENT_DN)) {
          vsdbncdec++;
          if (vsdbncdec > multispeed) {
-            n = multimul;
-            if(xpanelsfnbutton == 1) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_vvi_down_fast);
-               } else {
-                   while (n>0) {
-                      //XPLMCommandOnce(ApVsUp);
-                      upapvs = upapvs - 100;
-                      --n;
-                   }
-                }
-            }
+            multiac->vs_step(-1, xpanelsfnbutton == 1);
             vsdbncdec = 0;
-            if(xpanelsfnbutton == 0) {
-               if (loaded737 == 1){
-                  XPLMCommandOnce(x737mcp_vvi_down);
-               } else if (apvsdnremap == 1) {
-                  XPLMCommandOnce(ApVsDnRemapableCmd);
-               } else {
-                  //XPLMCommandOnce(ApVsUp);
-                  upapvs = upapvs - 100;
-               }
-               vsdbncdec = 0;
-            }
          }
 	  }
       upapvsf = upapvs;
@@ -298,78 +659,22 @@ void process_vs_switch()
 // ***************** IAS Switch Position *******************
 void process_ias_switch()
 {
-   if (testbit(multibuf,IAS_SWITCH)) {
+   if (panel_test(multiword, IAS_SWITCH)) {
       multiseldis = 2;
       upapasf = XPLMGetDataf(ApAs);
       upapas = (int)(upapasf);
-      if (testbit(multibuf,ADJUSTMENT_UP)) {
+      if (panel_test(multiword, ADJUSTMENT_UP)) {
          iasdbncinc++;
          if (iasdbncinc > multispeed) {
-            n = multimul;
-            if (xpanelsfnbutton == 1) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_spd_up_fast);
-               } else {
-                  while (n>0) {
-                     if (XPLMGetDatai(AirspeedIsMach) == 1) {
-                        XPLMSetDataf(Airspeed, XPLMGetDataf(Airspeed) + 0.01);
-                     } else {
-                        //XPLMCommandOnce(ApAsUp);
-                        upapas = upapas + 1;
-                     }
-                     --n;
-                  }
-               }
-               iasdbncinc = 0;
-            }
-            if (xpanelsfnbutton == 0) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_spd_up);
-               } else {
-                  if (XPLMGetDatai(AirspeedIsMach) == 1) {
-                     XPLMSetDataf(Airspeed, XPLMGetDataf(Airspeed) + 0.01);
-                  } else {
-                     //XPLMCommandOnce(ApAsUp);
-                     upapas = upapas + 1;
-                  }
-               }
-               iasdbncinc = 0;
-            }
+            multiac->ias_step(1, xpanelsfnbutton == 1);
+            iasdbncinc = 0;
          }
       }
-      if (testbit(multibuf,ADJUSTMENT_DN)) {
+      if (panel_test(multiword, ADJUSTMENT_DN)) {
          iasdbncdec++;
          if (iasdbncdec > multispeed) {
-            n = multimul;
-            if (xpanelsfnbutton == 1) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_spd_down_fast);
-               } else {
-                  while (n>0) {
-                     if (XPLMGetDatai(AirspeedIsMach) == 1) {
-                        XPLMSetDataf(Airspeed, XPLMGetDataf(Airspeed) - 0.01);
-                     } else {
-                        //XPLMCommandOnce(ApAsDn);
-                        upapas = upapas - 1;
-                     }
-                     --n;
-                  }
-               }
-               iasdbncdec = 0;
-            }
-            if (xpanelsfnbutton == 0) {
-               if (loaded737 == 1) {
-                  XPLMCommandOnce(x737mcp_spd_down);
-               } else {
-                  if (XPLMGetDatai(AirspeedIsMach) == 1) {
-                     XPLMSetDataf(Airspeed, XPLMGetDataf(Airspeed) - 0.01);
-                  } else {
-                     //XPLMCommandOnce(ApAsDn);
-                     upapas = upapas - 1;
-                  }
-               }
-               iasdbncdec = 0;
-            }
+            multiac->ias_step(-1, xpanelsfnbutton == 1);
+            iasdbncdec = 0;
          }
       }
       upapasf = upapas;
@@ -387,144 +692,88 @@ void process_hdg_switch()
 {
 
 
-	if(testbit(multibuf,HDG_SWITCH)) {
+	if(panel_test(multiword, HDG_SWITCH)) {
           multiseldis = 3;
-          upaphdgf = XPLMGetDataf(ApHdg);
-          upaphdg = (int)(upaphdgf);
-	  if(testbit(multibuf,ADJUSTMENT_UP)) {
+          if (hdgsampled == 0) {
+              multihdg = FixedAngle::from_float(XPLMGetDataf(ApHdg));
+              hdgsampled = 1;
+          }
+	  if(panel_test(multiword, ADJUSTMENT_UP)) {
 	    hdgdbncinc++;
             if (hdgdbncinc > multispeed) {
-                 if(xpanelsfnbutton == 1) {
-                     if (loaded737 == 1) {
-                         XPLMCommandOnce(x737mcp_hdg_up_fast);
-                     } else {
-                         upaphdg = upaphdg + multimul;
-                     }
-                     hdgdbncinc = 0;
-                 }
-                 if(xpanelsfnbutton == 0) {
-
-                     if (loaded737 == 1) {
-                         XPLMCommandOnce(x737mcp_hdg_up);
-                     } else {
-                         upaphdg = upaphdg + 1;
-                     }
-                     hdgdbncinc = 0;
-                 }
+                multiac->hdg_step(1, xpanelsfnbutton == 1);
+                hdgdbncinc = 0;
 	    }
 	  }
-	  if(testbit(multibuf,ADJUSTMENT_DN)) {
+	  if(panel_test(multiword, ADJUSTMENT_DN)) {
 	    hdgdbncdec++;
             if (hdgdbncdec > multispeed) {
-                if(xpanelsfnbutton == 1) {
-                    if (loaded737 == 1) {
-                        XPLMCommandOnce(x737mcp_hdg_down_fast);
-                    } else {
-                        upaphdg = upaphdg - multimul;
-                    }
-                    hdgdbncdec = 0;
-                }
-                if(xpanelsfnbutton == 0) {
-                    if (loaded737 == 1) {
-                        XPLMCommandOnce(x737mcp_hdg_down);
-                    } else {
-                        upaphdg = upaphdg - 1;
-                    }
-                    hdgdbncdec = 0;
-                }
+                multiac->hdg_step(-1, xpanelsfnbutton == 1);
+                hdgdbncdec = 0;
 	    }
 	  }
 
-          if (loaded737 != 1) {
-              if(upaphdg > 360){
-                  upaphdg = 1;
-              }
-              if(upaphdg < 0){
-                  upaphdg = 359;
-              }
-              upaphdgf = upaphdg;
-              XPLMSetDataf(ApHdg, upaphdgf);
-
-	}
+          upaphdg = multihdg.add(hdgaccum).whole();
     }
 }
 
 // ***************** CRS Switch Position *******************
-void process_crs_switch()
+void multi_crs_commit()
 {
+    if (crsaccum != 0) {
+        multicrs = multicrs.add(crsaccum);
+        crsaccum = 0;
+        XPLMSetDataf(multicrsref, multicrs.to_float());
+    }
+}
 
-
-    float cur_apcrsf = 0;
-    int   cur_apcrs  = 0;
+void process_crs_switch()
+{
 
     // if the toggle is selected, use nav2, otherwise, nav1
     XPLMDataRef crs_dataref =  !xpanelscrstoggle ? ApCrs : ApCrs2;
 
-	if(testbit(multibuf,CRS_SWITCH)) {
+	if(panel_test(multiword, CRS_SWITCH)) {
           multiseldis = 4;
-          upapcrsf = XPLMGetDataf(ApCrs);
-          upapcrs = (int)(upapcrsf);
 
           //  get the appropriate course setting depending on if the toggle is down
-          cur_apcrsf = XPLMGetDataf(crs_dataref);
-          cur_apcrs = (int)(cur_apcrsf);
+          if ((crssampled == 0) || (multicrsref != crs_dataref)) {
+              multi_crs_commit();
+              multicrsref = crs_dataref;
+              multicrs = FixedAngle::from_float(XPLMGetDataf(crs_dataref));
+              crssampled = 1;
+          }
 
-	  if(testbit(multibuf,ADJUSTMENT_UP)) {
+	  if(panel_test(multiword, ADJUSTMENT_UP)) {
 	    crsdbncinc++;
             if (crsdbncinc > multispeed) {
-
-                 if (xpanelsfnbutton == 1) {
-                    cur_apcrs = cur_apcrs + multimul;
-                }
-                if(xpanelsfnbutton == 0) {
-                    cur_apcrs = cur_apcrs + 1;
-                }
+                crsaccum = crsaccum + (xpanelsfnbutton == 1 ? multimul : 1);
                 crsdbncinc = 0;
              }
 	  }
 
-	  if(testbit(multibuf,ADJUSTMENT_DN)) {
+	  if(panel_test(multiword, ADJUSTMENT_DN)) {
 	    crsdbncdec++;
             if (crsdbncdec > multispeed) {
-
-                if (xpanelsfnbutton == 1) {
-                    cur_apcrs = cur_apcrs - multimul;
-                }
-                if(xpanelsfnbutton == 0) {
-                    cur_apcrs = cur_apcrs - 1;
-                }
-
+                crsaccum = crsaccum - (xpanelsfnbutton == 1 ? multimul : 1);
                 crsdbncdec = 0;
             }
           }
 
-          if(cur_apcrs > 360){
-              cur_apcrs = 1;
-          }
-
-          if(cur_apcrs < 0){
-              cur_apcrs = 359;
-          }
-
-          cur_apcrsf = cur_apcrs;
-          XPLMSetDataf(crs_dataref, cur_apcrsf);
-
-          //  set the appropriate global based on whether the crs toggle is on
-          if( !xpanelscrstoggle ) {
-              //  toggle off - nav1
-              upapcrsf = cur_apcrsf;
-              upapcrs  = cur_apcrs;
-          }
-          else {
-              //  toggle on - nav2
-              upapcrsf2 = cur_apcrsf;
-              upapcrs2   = cur_apcrs;
-              upapcrs   = cur_apcrs;
-          }
-
+          upapcrs = multicrs.add(crsaccum).whole();
 	}
 }
 
+// ***************** Commit HDG and CRS Detents *******************
+// Apply every detent seen this frame as one modular addition and one write.
+void process_multi_encoder_commit()
+{
+    multiac->hdg_commit();
+    multi_crs_commit();
+    hdgsampled = 0;
+    crssampled = 0;
+}
+
 // ***************** Auto Throttle Switch Position *******************
 void process_autothrottle_switch()
 {
@@ -533,594 +782,148 @@ void process_autothrottle_switch()
     }
 
 
-        if(testbit(multibuf,AUTO_THROTTLE_SWITCH)) {
-          if (loaded737 == 1){
-             XPLMSetDatai(x737athr_armed, 1);
-          }else{
-             XPLMSetDatai(ApAutThr, 1);
-          }
+        if(panel_test(multiword, AUTO_THROTTLE_SWITCH)) {
+           multiac->athr_set(1);
         }
         else {
-           if (loaded737 == 1){
-             XPLMSetDatai(x737athr_armed, 0);
-           }else{
-             XPLMSetDatai(ApAutThr, 0);
-           }
-         }
+           multiac->athr_set(0);
+        }
 }
 
-// ***************** AP Master Button and light *******************
+// ***************** AP Master Button *******************
 void process_ap_master_switch()
 {
 
-    if (loaded737 == 1) {
-        if (appushed == 0) {
-            if (testbit(multibuf, AP_MASTER_BUTTON)) {
-                XPLMCommandOnce(x737mcp_cmd_a_toggle);
-                appushed = 1;
-                lastappos = 1;
-            }
-        }
-
-        if (appushed == 1){
-           aploop++;
-            if (aploop == 50){
-               appushed = 0;
-               aploop = 0;
-            }
-
-        }
+    if ((appushed == 0) && (panel_test(multiword,  AP_MASTER_BUTTON))) {
+        multiac->ap_master_press();
+    }
 
-        switch (XPLMGetDatai(x737mcp_cmd_a_led)) {
-            case 0:
-                btnleds &= ~(1<<0);
-                break;
-            case 1:
-                btnleds |= (1<<0);
-                break;
-        }
-    } else {
-        if (appushed == 0) {
-          switch(XPLMGetDatai(ApMstrStat)){
-            case 0:
-             if(testbit(multibuf, AP_MASTER_BUTTON)) {
-                XPLMSetDatai(ApMstrStat, 1);
-                appushed = 1;
-                lastappos = 1;
-              }
-              break;
-            case 1:
-             if(testbit(multibuf, AP_MASTER_BUTTON)) {
-                 if (lastappos == 1){
-                   XPLMSetDatai(ApMstrStat, 2);
-                   appushed = 1;
-                 }
-                 if (lastappos == 2){
-                     XPLMSetDatai(ApMstrStat, 0);
-                     appushed = 1;
-                 }
-              }
-              break;
-            case 2:
-              if(testbit(multibuf, AP_MASTER_BUTTON)) {
-                 XPLMSetDatai(ApMstrStat, 1);
-                 appushed = 1;
-                 lastappos = 2;
-              }
-              break;
-          }
+    if (appushed == 1){
+       aploop++;
+        if (aploop == 50){
+           appushed = 0;
+           aploop = 0;
         }
 
-        if (appushed == 1){
-           aploop++;
-            if (aploop == 50){
-               appushed = 0;
-               aploop = 0;
-            }
-
-        }
-        
-        switch(XPLMGetDatai(ApMstrStat)){
-          case 0:
-            btnleds &= ~(1<<0);   // * clear bit 0 in btnleds to 0 *
-            break;
-          case 1:
-	    if (flashon == 1) {
-              btnleds |= (1<<0);   // * set bit 0 in btnleds to 1 *
-	    }else{   
-              btnleds &= ~(1<<0);   // * clear bit 0 in btnleds to 0 *
-	    }
-            break;
-          case 2:
-            btnleds |= (1<<0);   // * set bit 0 in btnleds to 1 *
-            break;
-        }
     }
 }
 
-// ***************** HDG Button and light *******************
+// ***************** HDG Button *******************
 void process_hdg_button()
 {
-
-    if (loaded737 == 1) {
-        if (multires > 0) {
-            if (testbit(multibuf, HDG_BUTTON)) {
-                XPLMCommandOnce(x737mcp_hdg_toggle);
-                lastappos = 1;
-            }
-        }
-
-        // Always match x737 glareshield LED
-        switch (XPLMGetDatai(x737mcp_hdg_led)) {
-            case 1:
-                btnleds |= (1<<1);
-                break;
-            case 0:
-                btnleds &= ~(1<<1);
-                break;
-        }
-    } else {
-        if (multires > 0) {
-          if(testbit(multibuf,HDG_BUTTON)) {
-
-            if(xpanelsfnbutton == 1) {
-                rhdgf = XPLMGetDataf(MHdg);
-                XPLMSetDataf(ApHdg, rhdgf);
-            }
-            if(xpanelsfnbutton == 0) {
-                XPLMCommandOnce(ApHdgBtn);
-                lastappos = 1;
-            }
-          }
-        }
-        
-        switch(XPLMGetDatai(ApHdgStat)){
-          case 2:
-            btnleds |= (1<<1);   // * set bit 1 in btnleds to 1 *
-            break;
-          case 1:
-            if (flashon == 1) {
-              btnleds |= (1<<1);   // * set bit 1 in btnleds to 1 *
-	    }else{   
-              btnleds &= ~(1<<1);   // * clear bit 1 in btnleds to 0 *
-	    }
-            break;
-          case 0:
-            btnleds &= ~(1<<1);   // * clear bit 1 in btnleds to 0 *
-            break;
-        }
-	if (XPLMGetDatai(ApMstrStat) == 0) {
-          btnleds &= ~(1<<1);   // * clear bit 1 in btnleds to 0 *
-	}
+    if (multires > 0) {
+      if(panel_test(multiword, HDG_BUTTON)) {
+        multiac->hdg_press();
+      }
     }
 }
 
-// ***************** NAV Button and light *******************
+// ***************** NAV Button *******************
 void process_nav_button()
 {
-
-    if (loaded737 == 1) {
-        if (multires > 0) {
-            if (testbit(multibuf, NAV_BUTTON)) {
-                switch (XPLMGetDatai(HsiSelector)) {
-                    case 0:
-                    case 1:
-                        XPLMCommandOnce(x737mcp_vorloc_toggle);
-                        break;
-                    case 2:
-                        XPLMCommandOnce(x737mcp_lnav_toggle);
-                        break;
-                }
-                lastappos = 1;
-            }
-        }
-
-        switch (XPLMGetDatai(HsiSelector)) {
-            case 0:
-            case 1:
-                // Use LED to match power state
-                switch (XPLMGetDatai(x737mcp_vorloc_led)) {
-                    case 1:
-                        btnleds |= (1<<2);
-                        break;
-                    case 0:
-                        // Although x737 LED has no armed status, the PFD does
-                        if (XPLMGetDatai(x737mcp_vorloc_armed)) {
-                            if (flashon == 1) {
-                                btnleds |= (1<<2);
-                            } else {
-                                btnleds &= ~(1<<2);
-                            }
-                        } else {
-                            btnleds &= ~(1<<2);
-                        }
-                        break;
-                }
-                break;
-            case 2:
-                switch (XPLMGetDatai(x737mcp_lnav)) {
-                    case 1:
-                        btnleds |= (1<<2);
-                        break;
-                    case 0:
-                        if (XPLMGetDatai(x737mcp_lnav_armed)) {
-                            if (flashon == 1) {
-                                btnleds |= (1<<2);
-                            } else {
-                                btnleds &= ~(1<<2);
-                            }
-                        } else {
-                            btnleds &= ~(1<<2);
-                        }
-                        break;
-                }
-                break;
-        }
-
-    } else if (navbuttonremap == 1){
-        if (multires > 0) {
-          if(testbit(multibuf,NAV_BUTTON)) {
-             XPLMCommandOnce(NavButtonRemapableCmd);
-             lastappos = 1;
-          }
-        }
-
-        switch(XPLMGetDatai(ApNavStat)){
-          case 2:
-            btnleds |= (1<<2);   // * set bit 2 in btnleds to 1 *
-            break;
-          case 1:
-            if (flashon == 1) {
-              btnleds |= (1<<2);   // * set bit 1 in btnleds to 1 *
-            }else{
-              btnleds &= ~(1<<2);   // * clear bit 2 in btnleds to 0 *
-            }
-            break;
-          case 0:
-            btnleds &= ~(1<<2);   // * clear bit 2 in btnleds to 0 *
-            break;
-        }
-
-
-    } else {
-        if (multires > 0) {
-          if(testbit(multibuf,NAV_BUTTON)) {
-            if(xpanelsfnbutton == 1) {
-                xpanelscrstoggle = !xpanelscrstoggle;
-            }
-            if(xpanelsfnbutton == 0) {
-                XPLMCommandOnce(ApNavBtn);
-                lastappos = 1;
-            }
-
-          }
-        }
-
-	switch(XPLMGetDatai(ApNavStat)){
-	  case 2:
-            btnleds |= (1<<2);   // * set bit 2 in btnleds to 1 *
-            break;
-          case 1:
-	    if (flashon == 1) {
-              btnleds |= (1<<2);   // * set bit 1 in btnleds to 1 *
-	    }else{
-              btnleds &= ~(1<<2);   // * clear bit 2 in btnleds to 0 *
-	    }
-	    break;
-	  case 0:
-            btnleds &= ~(1<<2);   // * clear bit 2 in btnleds to 0 *
-	    break;
-	}
-   }
-
-
-
-
+    if (multires > 0) {
+      if(panel_test(multiword, NAV_BUTTON)) {
+        multiac->nav_press();
+      }
+    }
 }
 
-// ***************** IAS Button and light ******************
+// ***************** IAS Button ******************
 void process_ias_button()
 {
-
-    if (loaded737 == 1) {
-         if (multires > 0) {
-             if (testbit(multibuf, IAS_BUTTON)) {
-                 if (xpanelsfnbutton == 1) {
-                     XPLMCommandOnce(x737mcp_spd_changeover);
-                 }
-                 if (xpanelsfnbutton == 0) {
-                     XPLMCommandOnce(x737mcp_lvlchange_toggle);
-                     lastappos = 1;
-                 }
-             }
-         }
-
-         // Always match x737 glareshield LED
-         switch (XPLMGetDatai(x737mcp_lvlchange_led)) {
-             case 1:
-                 btnleds |= (1<<3);
-                 break;
-             case 0:
-                 btnleds &= ~(1<<3);
-                 break;
-         }
-     } else {
-        if (multires > 0) {
-          if(testbit(multibuf,IAS_BUTTON)) {
-            if(xpanelsfnbutton == 1) {
-                 if (XPLMGetDatai(AirspeedIsMach) == 1) {
-                     XPLMSetDatai(AirspeedIsMach, 0);
-                 } else {
-                     XPLMSetDatai(AirspeedIsMach, 1);
-                 }
-             }
-             if(xpanelsfnbutton == 0) {
-                 XPLMCommandOnce(ApIasBtn);
-                 lastappos = 1;
-             }
-
-          }
-        }
-        switch(XPLMGetDatai(ApIasStat)){
-          case 2:
-            btnleds |= (1<<3);   // * set bit 3 in btnleds to 1 *
-            break;
-          case 1:
-            if (flashon == 1) {
-              btnleds |= (1<<3);   // * set bit 3 in btnleds to 1 *
-            }
-            if (flashon == 0) {
-              btnleds &= ~(1<<3);   // * clear bit 3 in btnleds to 0 *
-            }
-            break;
-          case 0:
-            btnleds &= ~(1<<3);   // * clear bit 3 in btnleds to 0 *
-            break;
-        }
+    if (multires > 0) {
+      if(panel_test(multiword, IAS_BUTTON)) {
+        multiac->ias_press();
+      }
     }
 }
 
-// ***************** ALT Button and light *******************
+// ***************** ALT Button *******************
 void process_alt_button()
 {
-
-    if (loaded737 == 1) {
-        if (multires > 0) {
-            if (testbit(multibuf, ALT_BUTTON)) {
-                XPLMCommandOnce(x737mcp_alt_toggle);
-                lastappos = 1;
-            }
-        }
-
-        // Always match x737 glareshield LED
-        switch (XPLMGetDatai(x737mcp_alt_led)) {
-            case 1:
-                btnleds |= (1<<4);
-                break;
-            case 0:
-                btnleds &= ~(1<<4);
-                break;
-        }
-    } else {
-        if (multires > 0) {
-          if(testbit(multibuf,ALT_BUTTON)) {
-           XPLMCommandOnce(ApAltBtn);
-           lastappos = 1;
-          }
-        }
-	switch(XPLMGetDatai(ApAltStat)){
-	  case 2:
-            btnleds |= (1<<4);   // * set bit 4 in btnleds to 1 *
-            break;
-          case 1:
-	    if (flashon == 1) {
-              btnleds |= (1<<4);   // * set bit 4 in btnleds to 1 *
-	    }else{    
-              btnleds &= ~(1<<4);   // * clear bit 4 in btnleds to 0 *
-	    }
-            break;
-          case 0:
-            btnleds &= ~(1<<4);   // * clear bit 4 in btnleds to 0 *
-            break;
-	} 
-	
-	if (XPLMGetDatai(ApMstrStat) == 0) {
-          btnleds &= ~(1<<4);   // * clear bit 4 in btnleds to 0 *
-	}
+    if (multires > 0) {
+      if(panel_test(multiword, ALT_BUTTON)) {
+        multiac->alt_press();
+      }
     }
 }
 
-// ***************** VS Button and light *******************
+// ***************** VS Button *******************
 void process_vs_button()
 {
-
-    if (loaded737 == 1) {
-        if (multires > 0) {
-            if (testbit(multibuf, VS_BUTTON)) {
-                XPLMCommandOnce(x737mcp_vs_toggle);
-                lastappos = 1;
-            }
-        }
-        switch (XPLMGetDatai(x737mcp_vvi_led)) {
-            case 1:
-                btnleds |= (1<<5);
-                break;
-            case 0:
-                if (XPLMGetDatai(x737mcp_vvi_armed_led)) {
-                    if (flashon == 0) {
-                        btnleds |= (1<<5);
-                    } else {
-                        btnleds &= ~(1<<5);
-                    }
-                } else {
-                    btnleds &= ~(1<<5);
-                }
-                break;
-        }
-    } else {
-        if (multires > 0) {
-          if(testbit(multibuf,VS_BUTTON)) {
-            XPLMCommandOnce(ApVsBtn);
-            lastappos = 1;
-          }
-        }
-	switch(XPLMGetDatai(ApVsStat)){
-	  case 2:
-            btnleds |= (1<<5);   // * set bit 5 in btnleds to 1 *
-            break;
-          case 1:
-	    if (flashon == 0) {
-              btnleds |= (1<<5);   // * set bit 5 in btnleds to 1 *
-	    }else{   
-              btnleds &= ~(1<<5);   // * clear bit 5 in btnleds to 0 *
-	    }
-            break;
-          case 0:
-            btnleds &= ~(1<<5);   // * clear bit 5 in btnleds to 0 *
-            break;
-        }
+    if (multires > 0) {
+      if(panel_test(multiword, VS_BUTTON)) {
+        multiac->vs_press();
+      }
     }
 }
 
-// ***************** APR Button and light *******************
+// ***************** APR Button *******************
 void process_apr_button()
 {
-
-    if (loaded737 == 1) {
-        if (multires > 0) {
-            if (testbit(multibuf, APR_BUTTON)) {
-                XPLMCommandOnce(x737mcp_app_toggle);
-                lastappos = 1;
-            }
-        }
-
-        // Always match x737 glareshield LED
-        switch (XPLMGetDatai(x737mcp_app_led)) {
-            case 1:
-                btnleds |= (1<<6);
-                break;
-            case 0:
-                btnleds &= ~(1<<6);
-                break;
-        }
-
-    } else if (aprbuttonremap == 1){
-        if (multires > 0) {
-          if(testbit(multibuf,APR_BUTTON)) {
-             XPLMCommandOnce(AprButtonRemapableCmd);
-             lastappos = 1;
-          }
-        }
-        switch(XPLMGetDatai(ApAprStat)){
-          case 2:
-            btnleds |= (1<<6);   // * set bit 6 in btnleds to 1 *
-            break;
-          case 1:
-            if (flashon == 1) {
-              btnleds |= (1<<6);   // * set bit 6 in btnleds to 1 *
-            }else{
-              btnleds &= ~(1<<6);   // * clear bit 6 in btnleds to 0 *
-            }
-            break;
-          case 0:
-            btnleds &= ~(1<<6);   // * clear bit 6 in btnleds to 0 *
-            break;
-        }
-
-    } else {
-        if (multires > 0) {
-          if(testbit(multibuf,APR_BUTTON)) {
-            if(xpanelsfnbutton == 1) {
-                rhdgf = XPLMGetDataf(MHdg);
-                XPLMSetDataf(ApCrs, rhdgf);
-            }
-            if(xpanelsfnbutton == 0) {
-                XPLMCommandOnce(ApAprBtn);
-                lastappos = 1;
-            }
-          }
-        }
-	switch(XPLMGetDatai(ApAprStat)){
-	  case 2:
-            btnleds |= (1<<6);   // * set bit 6 in btnleds to 1 *
-            break;
-          case 1:
-	    if (flashon == 1) {
-              btnleds |= (1<<6);   // * set bit 6 in btnleds to 1 *
-	    }else{   
-              btnleds &= ~(1<<6);   // * clear bit 6 in btnleds to 0 *
-	    }
-            break;
-          case 0:
-            btnleds &= ~(1<<6);   // * clear bit 6 in btnleds to 0 *
-            break;
-        }
+    if (multires > 0) {
+      if(panel_test(multiword, APR_BUTTON)) {
+        multiac->apr_press();
+      }
     }
 }
 
-// ***************** REV Button and light *******************
+// ***************** REV Button *******************
 void process_rev_button()
 {
     if (revbuttonremap == 1) {
         if (multires > 0) {
-          if(testbit(multibuf,REV_BUTTON)) {
+          if(panel_test(multiword, REV_BUTTON)) {
             XPLMCommandOnce(RevButtonRemapableCmd);
             lastappos = 1;
           }
         }
-	switch(XPLMGetDatai(ApRevStat)){
-	  case 2:
-            btnleds |= (1<<7);   // * set bit 7 in btnleds to 1 *
-            break;
-          case 1:
-	    if (flashon == 1) {
-              btnleds |= (1<<7);   // * set bit 7 in btnleds to 1 *
-	    }else{    
-              btnleds &= ~(1<<7);   // * clear bit 7 in btnleds to 0 *
-	    }
-            break;
-          case 0:
-            btnleds &= ~(1<<7);   // * clear bit 7 in btnleds to 0 *
-            break;
-	} 
     } else {
 
         if (multires > 0) {
-          if(testbit(multibuf,REV_BUTTON)) {
+          if(panel_test(multiword, REV_BUTTON)) {
             XPLMCommandOnce(ApRevBtn);
             lastappos = 1;
           }
         }
-        switch(XPLMGetDatai(ApRevStat)){
-          case 2:
-            btnleds |= (1<<7);   // * set bit 7 in btnleds to 1 *
-            break;
-          case 1:
-            if (flashon == 1) {
-              btnleds |= (1<<7);   // * set bit 7 in btnleds to 1 *
-            }else{
-              btnleds &= ~(1<<7);   // * clear bit 7 in btnleds to 0 *
-            }
-            break;
-          case 0:
-            btnleds &= ~(1<<7);   // * clear bit 7 in btnleds to 0 *
-            break;
-        }
 
     }
 
 }
 
+// ***************** Autopilot Status Sample *******************
+// Sample the autopilot status vector once per frame into apstatebits.
+void process_multi_ap_state()
+{
+    apstatebits = 0;
+    multiac->ap_state();
+    multi_ap_pack(7, XPLMGetDatai(ApRevStat));
+}
+
+// ***************** Button LEDS from Status Bitfield *******************
+void process_multi_btnleds()
+{
+    unsigned char engaged = apstatebits & 0xFF;
+    unsigned char armed = (apstatebits >> 8) & 0xFF;
+
+    btnleds = engaged | (armed & multiarmedmask[flashon]);
+
+    // * AP master off (bit 0 neither engaged nor armed) *
+    if (((engaged | armed) & 0x01) == 0) {
+        btnleds &= ~multiac->mastermask;
+    }
+}
+
 // ***************** Flaps Switch *******************
 void process_flaps_switch()
 {
-    if (XPLMGetDatai(BatPwrOn) == 1) {
+    if (buspower & BUS_POWER_BATTERY) {
 
         if (multires > 0) {
-	  if(testbit(multibuf,FLAPS_UP_SWITCH)) {
+	  if(panel_test(multiword, FLAPS_UP_SWITCH)) {
 	    XPLMCommandOnce(FlapsUp);	 
           }
-	  if(testbit(multibuf,FLAPS_DN_SWITCH)) {
+	  if(panel_test(multiword, FLAPS_DN_SWITCH)) {
 	    XPLMCommandOnce(FlapsDn);	 
 	  }
         }
@@ -1133,12 +936,12 @@ void process_trim_wheel()
 
   int i;
         if (multires > 0) {
-	  if(testbit(multibuf,TRIM_WHEEL_UP)) {
+	  if(panel_test(multiword, TRIM_WHEEL_UP)) {
 	    for(i = 0; i < trimspeed; ++i){
               XPLMCommandOnce(PitchTrimUp);
 	    }
 	  }	
-	  if(testbit(multibuf,TRIM_WHEEL_DN)) {
+	  if(panel_test(multiword, TRIM_WHEEL_DN)) {
 	    for(i = 0; i < trimspeed; ++i){
               XPLMCommandOnce(PitchTrimDn);
             }
@@ -1163,19 +966,52 @@ if (flashcnt == 100) {
 }
 }
 
+// ***************** Bus Power *******************
+// * the blank report goes out once, the send stage only writes on change *
+void process_multi_power(int state)
+{
+    multipowered = ((state & BUS_POWER_DISPLAYS) == BUS_POWER_DISPLAYS);
+}
+
 // ***************** Blank Display *******************
 void process_multi_blank_display()
 {
 
-if (XPLMGetDatai(AvPwrOn) == 0) {
+if (!multipowered) {
   multiseldis = 5;
 }
-if (XPLMGetDatai(BatPwrOn) == 0) {
-  multiseldis = 5;
+
 }
 
+
+// ***************** Display Content Hash *******************
+// FNV-1a over the whole display report, digits and button LEDS included.
+unsigned int multi_display_hash()
+{
+    unsigned int hash = 2166136261u;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(multiwbuf); i++) {
+        hash = (hash ^ multiwbuf[i]) * 16777619u;
+    }
+    return hash;
 }
 
+// ***************** Send Display on Change *******************
+// Only write when the report content changes, plus a slow keepalive in
+// case the panel missed a report.
+void process_multi_send()
+{
+    unsigned int hash = multi_display_hash();
+    float now = XPLMGetElapsedTime();
+
+    if ((hash != lastmultihash) || ((now - lastmultiwrite) > multikeepalive)) {
+        mulres = hid_send_feature_report(multihandle, multiwbuf, sizeof(multiwbuf));
+        multiusbwrites++;
+        lastmultihash = hash;
+        lastmultiwrite = now;
+    }
+}
 
 // ***** Multi Panel Process ******
 void process_multi_panel()
@@ -1188,6 +1024,9 @@ void process_multi_panel()
   int multi_safety_cntr = 30;
   do{
     multires = hid_read(multihandle, multibuf, sizeof(multibuf));
+    if (multires > 0) {
+        multiword = panel_report_word(multibuf);
+    }
     
     process_alt_switch();
     process_vs_switch();
@@ -1207,25 +1046,25 @@ void process_multi_panel()
     process_trim_wheel();
     if(multires > 0){
        process_multi_flash();
+       process_multi_btnleds();
        process_multi_blank_display();
        process_multi_display();
-       hid_send_feature_report(multihandle, multiwbuf, sizeof(multiwbuf));
+       process_multi_send();
     }
     --multi_safety_cntr;
   }while((multires > 0) && (multi_safety_cntr > 0));
 
+  process_multi_encoder_commit();
+
+// ******* Sample autopilot status once per frame ********
+  process_multi_ap_state();
+
   process_multi_flash();
+  process_multi_btnleds();
   process_multi_blank_display();
   process_multi_display();
   
-// ******* Write on changes or timeout ********
-  if ((lastmultiseldis != multiseldis) || (lastbtnleds != btnleds) || (multinowrite > 50)) {
-      mulres = hid_send_feature_report(multihandle, multiwbuf, sizeof(multiwbuf));
-      multinowrite = 1;
-      lastmultiseldis = multiseldis;
-      lastbtnleds = btnleds;
-  }else{
-      multinowrite++;
-  }
+// ******* Write on changes or keepalive ********
+  process_multi_send();
   return;
 }
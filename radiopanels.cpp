@@ -21,7 +21,6 @@
 #include <string>
 using namespace std;
 
-#define testbit(x, y)  ( ( ((const char*)&(x))[(y)>>3] & 0x80 >> ((y)&0x07)) >> (7-((y)&0x07) ) )
 
 enum Buttons {
   COARSE_UP = 0,
@@ -518,6 +517,22 @@ Radio::Radio(hid_device *device) {
   handle = device;
   upper = NULL;
   lower = NULL;
+  powered = 1;
+}
+
+// * blank once when the displays lose power, writes resume when it returns *
+void Radio::power(int state) {
+  int on = ((state & BUS_POWER_DISPLAYS) == BUS_POWER_DISPLAYS);
+
+  if (on == powered) {
+    return;
+  }
+  powered = on;
+  if (!powered) {
+    memset(write_buffer, 15, sizeof(write_buffer));
+    write_buffer[0] = 0;
+    hid_send_feature_report(handle, write_buffer, sizeof(write_buffer));
+  }
 }
 
 Radio::~Radio() {
@@ -536,6 +551,7 @@ Radio::~Radio() {
 
 void Radio::update() {
   hid_read(handle, read_buffer, sizeof(read_buffer));
+  panel_word word = panel_report_word(read_buffer);
 
   enum Mode upperMode, lowerMode;
 
@@ -543,60 +559,62 @@ void Radio::update() {
   if (lower) lowerMode = lower->mode; else lowerMode = INVALID;
 
   // upper panel
-  if (testbit(read_buffer, UPPER_COM1) && upperMode != COM1) {
+  if (panel_test(word, UPPER_COM1) && upperMode != COM1) {
     setUpper(new COM1RadioPanel());
-  } else if (testbit(read_buffer, UPPER_COM2) && upperMode != COM2) {
+  } else if (panel_test(word, UPPER_COM2) && upperMode != COM2) {
     setUpper(new COM2RadioPanel());
-  } else if (testbit(read_buffer, UPPER_NAV1) && upperMode != NAV1) {
+  } else if (panel_test(word, UPPER_NAV1) && upperMode != NAV1) {
     setUpper(new NAV1RadioPanel());
-  } else if (testbit(read_buffer, UPPER_NAV2) && upperMode != NAV2) {
+  } else if (panel_test(word, UPPER_NAV2) && upperMode != NAV2) {
     setUpper(new NAV2RadioPanel());
-  } else if (testbit(read_buffer, UPPER_ADF) && upperMode != ADF) {
+  } else if (panel_test(word, UPPER_ADF) && upperMode != ADF) {
     setUpper(new ADFPanel());
-  } else if (testbit(read_buffer, UPPER_DME) && upperMode != DME) {
+  } else if (panel_test(word, UPPER_DME) && upperMode != DME) {
     setUpper(new DMEPanel());
-  } else if (testbit(read_buffer, UPPER_XPDR) && upperMode != XPDR) {
+  } else if (panel_test(word, UPPER_XPDR) && upperMode != XPDR) {
     setUpper(new XPDRPanel());
   } 
 
   // upper panel
-  if (testbit(read_buffer, LOWER_COM1) && lowerMode != COM1) {
+  if (panel_test(word, LOWER_COM1) && lowerMode != COM1) {
     setLower(new COM1RadioPanel());
-  } else if (testbit(read_buffer, LOWER_COM2) && lowerMode != COM2) {
+  } else if (panel_test(word, LOWER_COM2) && lowerMode != COM2) {
     setLower(new COM2RadioPanel());
-  } else if (testbit(read_buffer, LOWER_NAV1) && lowerMode != NAV1) {
+  } else if (panel_test(word, LOWER_NAV1) && lowerMode != NAV1) {
     setLower(new NAV1RadioPanel());
-  } else if (testbit(read_buffer, LOWER_NAV2) && lowerMode != NAV2) {
+  } else if (panel_test(word, LOWER_NAV2) && lowerMode != NAV2) {
     setLower(new NAV2RadioPanel());
-  } else if (testbit(read_buffer, LOWER_ADF) && lowerMode != ADF) {
+  } else if (panel_test(word, LOWER_ADF) && lowerMode != ADF) {
     setLower(new ADFPanel());
-  } else if (testbit(read_buffer, LOWER_DME) && lowerMode != DME) {
+  } else if (panel_test(word, LOWER_DME) && lowerMode != DME) {
     setLower(new DMEPanel());
-  } else if (testbit(read_buffer, LOWER_XPDR) && lowerMode != XPDR) {
+  } else if (panel_test(word, LOWER_XPDR) && lowerMode != XPDR) {
     setLower(new XPDRPanel());
   } 
 
   if (upper) {
-    if (testbit(read_buffer, UPPER_COARSE_UP)) upper->handleRawButton(COARSE_UP);
-    if (testbit(read_buffer, UPPER_COARSE_DN)) upper->handleRawButton(COARSE_DOWN);
-    if (testbit(read_buffer, UPPER_FINE_UP)) upper->handleRawButton(FINE_UP);
-    if (testbit(read_buffer, UPPER_FINE_DN)) upper->handleRawButton(FINE_DOWN);
-    if (testbit(read_buffer, UPPER_ACT_STBY)) upper->handleRawButton(ACTIVE_STANDBY);
+    if (panel_test(word, UPPER_COARSE_UP)) upper->handleRawButton(COARSE_UP);
+    if (panel_test(word, UPPER_COARSE_DN)) upper->handleRawButton(COARSE_DOWN);
+    if (panel_test(word, UPPER_FINE_UP)) upper->handleRawButton(FINE_UP);
+    if (panel_test(word, UPPER_FINE_DN)) upper->handleRawButton(FINE_DOWN);
+    if (panel_test(word, UPPER_ACT_STBY)) upper->handleRawButton(ACTIVE_STANDBY);
 
     upper->update();
   }
 
   if (lower) {
-    if (testbit(read_buffer, LOWER_COARSE_UP)) lower->handleRawButton(COARSE_UP);
-    if (testbit(read_buffer, LOWER_COARSE_DN)) lower->handleRawButton(COARSE_DOWN);
-    if (testbit(read_buffer, LOWER_FINE_UP)) lower->handleRawButton(FINE_UP);
-    if (testbit(read_buffer, LOWER_FINE_DN)) lower->handleRawButton(FINE_DOWN);
-    if (testbit(read_buffer, LOWER_ACT_STBY)) lower->handleRawButton(ACTIVE_STANDBY);
+    if (panel_test(word, LOWER_COARSE_UP)) lower->handleRawButton(COARSE_UP);
+    if (panel_test(word, LOWER_COARSE_DN)) lower->handleRawButton(COARSE_DOWN);
+    if (panel_test(word, LOWER_FINE_UP)) lower->handleRawButton(FINE_UP);
+    if (panel_test(word, LOWER_FINE_DN)) lower->handleRawButton(FINE_DOWN);
+    if (panel_test(word, LOWER_ACT_STBY)) lower->handleRawButton(ACTIVE_STANDBY);
 
     lower->update();
   }
 
-  writeToRadio();
+  if (powered) {
+    writeToRadio();
+  }
 }
 
 void Radio::writeToRadio() {
@@ -736,6 +754,7 @@ static int lastupseldis[4] = {1, 1, 1, 1}, lastloseldis[4] = {1, 1, 1, 1};
 static int upmodeturnoff, lomodeturnoff;
 
 static unsigned char radiobuf[4][4];
+static panel_word radioword[4];
 static unsigned char radiowbuf[4][23];
 
 void process_upper_nav_com_freq();
@@ -966,17 +985,17 @@ void process_radio_upper_display()
             radiobdig5 = radiobrem4;
           }
 
-          if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+          if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upmodeturnoff = 0;
           }
-          if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upmodeturnoff = 0;
           }
 
-          if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
               upmodeturnoff = 0;
           }
-          if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
               upmodeturnoff = 0;
           }
 
@@ -1253,17 +1272,17 @@ void process_radio_lower_display()
         radioddig5 = radiodrem4;
       }
 
-      if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+      if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
           lomodeturnoff = 0;
       }
-      if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+      if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
           lomodeturnoff = 0;
       }
 
-      if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+      if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
           lomodeturnoff = 0;
       }
-      if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+      if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
           lomodeturnoff = 0;
       }
 
@@ -1353,38 +1372,38 @@ void process_radio_make_message()
 void process_upper_com1_switch()
 {
 
-    if(testbit(radiobuf[radnum],UPPER_COM1)) {
+    if(panel_test(radioword[radnum], UPPER_COM1)) {
       upseldis[radnum] = 1;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
           upcom1dbncfninc[radnum]++;
           if (upcom1dbncfninc[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyFineUp);
 	    upcom1dbncfninc[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
 	  upcom1dbncfndec[radnum]++;
           if (upcom1dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyFineDn);
 	    upcom1dbncfndec[radnum] = 0;
 	  }	
         }
-        if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
 	  upcom1dbnccorinc[radnum]++;
           if (upcom1dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyCorseUp);
 	    upcom1dbnccorinc[radnum] = 0;
 	  }
         }  
-        if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
 	  upcom1dbnccordec[radnum]++;
           if (upcom1dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyCorseDn);
 	    upcom1dbnccordec[radnum] = 0;
 	  }
         }
-	if(testbit(radiobuf[radnum],UPPER_ACT_STBY)) {
+	if(panel_test(radioword[radnum], UPPER_ACT_STBY)) {
           XPLMCommandOnce(Com1ActStby);
         }
       }   
@@ -1400,38 +1419,38 @@ void process_upper_com2_switch()
 {
 
 
-    if(testbit(radiobuf[radnum],UPPER_COM2)) {
+    if(panel_test(radioword[radnum], UPPER_COM2)) {
       upseldis[radnum] = 2;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
           upcom2dbncfninc[radnum]++;
           if (upcom2dbncfninc[radnum] > radspeed) {
 	    XPLMCommandOnce(Com2StbyFineUp);
 	    upcom2dbncfninc[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
 	  upcom2dbncfndec[radnum]++;
           if (upcom2dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Com2StbyFineDn);
 	    upcom2dbncfndec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
 	  upcom2dbnccorinc[radnum]++;
           if (upcom2dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Com2StbyCorseUp);
 	    upcom2dbnccorinc[radnum] = 0;
 	  }   
         }  
-        if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
 	  upcom2dbnccordec[radnum]++;
           if (upcom2dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Com2StbyCorseDn);
 	    upcom2dbnccordec[radnum] = 0;
 	  }
         }
-	if(testbit(radiobuf[radnum],UPPER_ACT_STBY)) {
+	if(panel_test(radioword[radnum], UPPER_ACT_STBY)) {
 	  XPLMCommandOnce(Com2ActStby);
         }
       }
@@ -1447,38 +1466,38 @@ void process_upper_nav1_switch()
 {
 
 
-    if(testbit(radiobuf[radnum],UPPER_NAV1)) {
+    if(panel_test(radioword[radnum], UPPER_NAV1)) {
       upseldis[radnum] = 3;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
           upnav1dbncfninc[radnum]++;
           if (upnav1dbncfninc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyFineUp);
 	    upnav1dbncfninc[radnum] = 0;
 	  } 
         }
-        if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
 	  upnav1dbncfndec[radnum]++;
           if (upnav1dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyFineDn);
 	    upnav1dbncfndec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
 	  upnav1dbnccorinc[radnum]++;
           if (upnav1dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyCorseUp);
 	    upnav1dbnccorinc[radnum] = 0;
 	  }
         }  
-        if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
 	  upnav1dbnccordec[radnum]++;
           if (upnav1dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyCorseDn);
 	    upnav1dbnccordec[radnum] = 0;
 	  }
         }
-	if(testbit(radiobuf[radnum],UPPER_ACT_STBY)) {
+	if(panel_test(radioword[radnum], UPPER_ACT_STBY)) {
 	  XPLMCommandOnce(Nav1ActStby);
         }
       } 
@@ -1496,31 +1515,31 @@ void process_upper_nav2_switch()
 {
 
 
-    if(testbit(radiobuf[radnum],UPPER_NAV2)) {
+    if(panel_test(radioword[radnum], UPPER_NAV2)) {
       upseldis[radnum] = 4;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
           upnav2dbncfninc[radnum]++;
           if (upnav2dbncfninc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyFineUp);
 	    upnav2dbncfninc[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
 	  upnav2dbncfndec[radnum]++;
           if (upnav2dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyFineDn);
 	    upnav2dbncfndec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
 	  upnav2dbnccorinc[radnum]++;
           if (upnav2dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyCorseUp);
 	    upnav2dbnccorinc[radnum] = 0;
 	  }
         }  
-        if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
 	  upnav2dbnccordec[radnum]++;
           if (upnav2dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyCorseDn);
@@ -1528,7 +1547,7 @@ void process_upper_nav2_switch()
 	  }
         }
 
-	if(testbit(radiobuf[radnum],UPPER_ACT_STBY)) {
+	if(panel_test(radioword[radnum], UPPER_ACT_STBY)) {
 	  XPLMCommandOnce(Nav2ActStby);
         }
       }
@@ -1546,18 +1565,18 @@ void proecss_upper_adf_switch()
 
 
 
-    if(testbit(radiobuf[radnum],UPPER_ADF)) {
+    if(panel_test(radioword[radnum], UPPER_ADF)) {
       upseldis[radnum] = 5;
       if (radiores > 0) {
         if (upadfsel[radnum] == 1) {
-	  if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+	  if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
 	    upadfdbncfninc[radnum]++;
             if (upadfdbncfninc[radnum] > radspeed) {
               XPLMCommandOnce(Afd1StbyOnesUp);
 	      upadfdbncfninc[radnum] = 0;
 	    }
           }
-          if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
 	    upadfdbncfndec[radnum]++;
             if (upadfdbncfndec[radnum] > radspeed) {
               XPLMCommandOnce(Afd1StbyOnesDn);
@@ -1566,14 +1585,14 @@ void proecss_upper_adf_switch()
           }
 	}
           if (upadfsel[radnum] == 2) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
 	      upadfdbncfninc[radnum]++;
               if (upadfdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyTensUp);
 	        upadfdbncfninc[radnum] = 0;
 	      }		
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
 	      upadfdbncfndec[radnum]++;
               if (upadfdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyTensDn);
@@ -1582,14 +1601,14 @@ void proecss_upper_adf_switch()
             }
 	  }
           if (upadfsel[radnum] == 3) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upadfdbncfninc[radnum]++;
               if (upadfdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyHunUp);
                 upadfdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upadfdbncfndec[radnum]++;
               if (upadfdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyHunDn);
@@ -1599,7 +1618,7 @@ void proecss_upper_adf_switch()
           }
 
   // Use the Coarse knob to select digit in the up direction
-          if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
             upadfdbnccorinc[radnum] ++;
             if(upadfdbnccorinc[radnum] > radspeed) {
               upadfsel[radnum] ++;
@@ -1611,7 +1630,7 @@ void proecss_upper_adf_switch()
           }
 
   // Use the Coarse knob to select digit in the down direction
-          if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
             upadfdbnccordec[radnum] ++;
             if(upadfdbnccordec[radnum] > radspeed) {
               upadfsel[radnum] --;
@@ -1622,7 +1641,7 @@ void proecss_upper_adf_switch()
             }
           }
 
-          if(testbit(radiobuf[radnum],UPPER_ACT_STBY)) {
+          if(panel_test(radioword[radnum], UPPER_ACT_STBY)) {
             XPLMCommandOnce(Adf1ActStby);
           }
 
@@ -1640,14 +1659,14 @@ void process_upper_dme_switch()
 
 
 
-    if(testbit(radiobuf[radnum],UPPER_DME)) {
+    if(panel_test(radioword[radnum], UPPER_DME)) {
 
       // ****** Function button is not pushed  *******
       if(xpanelsfnbutton == 0) {
 
         if (updmepushed == 0) {
           if (XPLMGetDatai(DmeMode) == 0) {
-             if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                 XPLMSetDatai(DmeMode, 1);
                 updmepushed = 1;
                 uplastdmepos = 0;
@@ -1657,7 +1676,7 @@ void process_upper_dme_switch()
 
         if (updmepushed == 0) {
           if (XPLMGetDatai(DmeMode) == 1) {
-             if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                  if (uplastdmepos == 0){
                    XPLMSetDatai(DmeMode, 2);
                    updmepushed = 1;
@@ -1672,7 +1691,7 @@ void process_upper_dme_switch()
 
         if (updmepushed == 0) {
           if (XPLMGetDatai(DmeMode) == 2) {
-              if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+              if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                  XPLMSetDatai(DmeMode, 1);
                  updmepushed = 1;
                  uplastdmepos = 2;
@@ -1716,7 +1735,7 @@ void process_upper_dme_switch()
           updmefreq[radnum] = XPLMGetDatai(DmeFreq);
           updmefreqhnd = updmefreq[radnum]/100;
           updmefreqfrc = updmefreq[radnum]%100;
-          if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+          if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
             if (updmefreqfrc == 95) {
                 updmefreqfrc = 0;
             }
@@ -1726,7 +1745,7 @@ void process_upper_dme_switch()
               updmedbncfninc[radnum] = 0;
             }
           }
-          if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
             if (updmefreqfrc == 0) {
                 updmefreqfrc = 95;
             }
@@ -1737,7 +1756,7 @@ void process_upper_dme_switch()
             }
           }
 
-          if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
             if (updmefreqhnd == 117) {
                 updmefreqhnd = 108;
             }
@@ -1747,7 +1766,7 @@ void process_upper_dme_switch()
               updmedbncfninc[radnum] = 0;
             }
           }
-          if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
             if (updmefreqhnd == 108) {
                 updmefreqhnd = 117;
             }
@@ -1779,7 +1798,7 @@ void process_upper_dme_switch()
 
         if (updmepushed == 0) {
           if (XPLMGetDatai(DmeSlvSource) == 0) {
-             if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                 XPLMSetDatai(DmeSlvSource, 1);
                 updmepushed = 1;
                 uplastdmepos = 0;
@@ -1789,7 +1808,7 @@ void process_upper_dme_switch()
 
         if (updmepushed == 0) {
           if (XPLMGetDatai(DmeSlvSource) == 1) {
-             if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                 XPLMSetDatai(DmeSlvSource, 0);
                 updmepushed = 1;
 
@@ -1822,20 +1841,20 @@ void process_upper_xpdr_switch()
 
 
 
-    if(testbit(radiobuf[radnum],UPPER_XPDR)) {
+    if(panel_test(radioword[radnum], UPPER_XPDR)) {
       upseldis[radnum] = 9;
 
 // ****** Function button is not pushed  *******
         if(xpanelsfnbutton == 0) {
           if (upxpdrsel[radnum] == 1) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upxpdrdbncfninc[radnum]++;
               if (upxpdrdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrOnesUp);
                 upxpdrdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upxpdrdbncfndec[radnum]++;
               if (upxpdrdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrOnesDn);
@@ -1846,14 +1865,14 @@ void process_upper_xpdr_switch()
           }
 
           else if (upxpdrsel[radnum] == 2) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upxpdrdbncfninc[radnum]++;
               if (upxpdrdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrTensUp);
                 upxpdrdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upxpdrdbncfndec[radnum]++;
               if (upxpdrdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrTensDn);
@@ -1864,14 +1883,14 @@ void process_upper_xpdr_switch()
           }
 
           else if (upxpdrsel[radnum] == 3) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upxpdrdbncfninc[radnum]++;
               if (upxpdrdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrHunUp);
                 upxpdrdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upxpdrdbncfndec[radnum]++;
               if (upxpdrdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrHunDn);
@@ -1882,14 +1901,14 @@ void process_upper_xpdr_switch()
           }
 
           else if (upxpdrsel[radnum] == 4) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upxpdrdbncfninc[radnum]++;
               if (upxpdrdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrThUp);
                 upxpdrdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upxpdrdbncfndec[radnum]++;
               if (upxpdrdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(XpdrThDn);
@@ -1900,7 +1919,7 @@ void process_upper_xpdr_switch()
           }
 
   // Use the Coarse knob to select digit in the up direction
-          if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
             upxpdrdbnccorinc[radnum]++;
             if(upxpdrdbnccorinc[radnum] > radspeed) {
                upxpdrsel[radnum] ++;
@@ -1911,7 +1930,7 @@ void process_upper_xpdr_switch()
             }
           }
   // Use the Coarse knob to select digit in the down direction
-          if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+          if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
             upxpdrdbnccordec[radnum]++;
             if(upxpdrdbnccordec[radnum] > radspeed) {
                upxpdrsel[radnum] --;
@@ -1926,7 +1945,7 @@ void process_upper_xpdr_switch()
 
           if (upxpdrpushed == 0) {
             if (XPLMGetDatai(XpdrMode) == 0) {
-               if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+               if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                   XPLMSetDatai(XpdrMode, 1);
                   upxpdrpushed = 1;
                   uplastxpdrpos = 0;
@@ -1936,7 +1955,7 @@ void process_upper_xpdr_switch()
 
           if (upxpdrpushed == 0) {
             if (XPLMGetDatai(XpdrMode) == 1) {
-               if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+               if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                    if (uplastxpdrpos == 0){
                      XPLMSetDatai(XpdrMode, 2);
                      upxpdrpushed = 1;
@@ -1951,7 +1970,7 @@ void process_upper_xpdr_switch()
           }
           if (upxpdrpushed == 0) {
             if (XPLMGetDatai(XpdrMode) == 2) {
-               if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+               if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                    if (uplastxpdrpos == 1){
                      XPLMSetDatai(XpdrMode, 3);
                      upxpdrpushed = 1;
@@ -1968,7 +1987,7 @@ void process_upper_xpdr_switch()
 
           if (upxpdrpushed == 0) {
             if (XPLMGetDatai(XpdrMode) == 3) {
-                if(testbit(radiobuf[radnum], UPPER_ACT_STBY)) {
+                if(panel_test(radioword[radnum],  UPPER_ACT_STBY)) {
                    XPLMSetDatai(XpdrMode, 2);
                    upxpdrpushed = 1;
                    uplastxpdrpos = 3;
@@ -1991,14 +2010,14 @@ void process_upper_xpdr_switch()
 
 // ****** Function button is pushed ******
         if(xpanelsfnbutton == 1) {
-            if(testbit(radiobuf[radnum],UPPER_FINE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_UP)) {
               upqnhdbncfninc[radnum]++;
               if (upqnhdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(BaroUp);
                 upqnhdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_FINE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_FINE_DN)) {
               upqnhdbncfndec[radnum]++;
               if (upqnhdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(BaroDn);
@@ -2006,7 +2025,7 @@ void process_upper_xpdr_switch()
               }
             }
 
-            if(testbit(radiobuf[radnum],UPPER_COARSE_UP)) {
+            if(panel_test(radioword[radnum], UPPER_COARSE_UP)) {
               upqnhdbnccorinc[radnum]++;
               if (upqnhdbnccorinc[radnum] > radspeed) {
                  radn = 10;
@@ -2017,7 +2036,7 @@ void process_upper_xpdr_switch()
                  upqnhdbnccorinc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],UPPER_COARSE_DN)) {
+            if(panel_test(radioword[radnum], UPPER_COARSE_DN)) {
               upqnhdbnccordec[radnum]++;
               if (upqnhdbnccordec[radnum] > radspeed) {
                   radn = 10;
@@ -2028,7 +2047,7 @@ void process_upper_xpdr_switch()
                   upqnhdbnccordec[radnum] = 0;
               }
             }
-           if(testbit(radiobuf[radnum],UPPER_ACT_STBY)) {
+           if(panel_test(radioword[radnum], UPPER_ACT_STBY)) {
              XPLMCommandOnce(BaroStd);
            }
 
@@ -2057,38 +2076,38 @@ void process_lower_com1_switch()
 
 
 
-    if(testbit(radiobuf[radnum],LOWER_COM1)) {
+    if(panel_test(radioword[radnum], LOWER_COM1)) {
       loseldis[radnum] = 1;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+        if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
           locom1dbncfninc[radnum]++;
           if (locom1dbncfninc[radnum] > radspeed) {
             XPLMCommandOnce(Com1StbyFineUp);
             locom1dbncfninc[radnum] = 0;
           }
         }
-        if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+        if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
 	  locom1dbncfndec[radnum]++;
           if (locom1dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyFineDn);
 	    locom1dbncfndec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
 	  locom1dbnccorinc[radnum]++;
           if (locom1dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyCorseUp);
 	    locom1dbnccorinc[radnum] = 0;
 	  }
         }  
-        if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
 	  locom1dbnccordec[radnum]++;
           if (locom1dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Com1StbyCorseDn);
 	    locom1dbnccordec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+        if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
 	  XPLMCommandOnce(Com1ActStby);
         }
       }
@@ -2106,38 +2125,38 @@ void process_lower_com2_switch()
 
 
 
-   if(testbit(radiobuf[radnum],LOWER_COM2)) {
+   if(panel_test(radioword[radnum], LOWER_COM2)) {
      loseldis[radnum] = 2;
      if (radiores > 0) {
-       if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+       if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
          locom2dbncfninc[radnum]++;
          if (locom2dbncfninc[radnum] > radspeed) {
            XPLMCommandOnce(Com2StbyFineUp);
 	   locom2dbncfninc[radnum] = 0;
 	 }
        }
-       if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+       if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
          locom2dbncfndec[radnum]++;
          if (locom2dbncfndec[radnum] > radspeed) {
 	   XPLMCommandOnce(Com2StbyFineDn);
 	   locom2dbncfndec[radnum] = 0;
 	 }
        }
-       if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+       if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
          locom2dbnccorinc[radnum]++;
          if (locom2dbnccorinc[radnum] > radspeed) {
 	   XPLMCommandOnce(Com2StbyCorseUp);
 	   locom2dbnccorinc[radnum] = 0;
 	 }
        }  
-       if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+       if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
          locom2dbnccordec[radnum]++;
          if (locom2dbnccordec[radnum] > radspeed) {
 	   XPLMCommandOnce(Com2StbyCorseDn);
 	   locom2dbnccordec[radnum] = 0;
 	 }
        }
-       if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+       if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
          XPLMCommandOnce(Com2ActStby);
        }
      }
@@ -2154,31 +2173,31 @@ void process_lower_nav1_switch()
 
 
 
-    if(testbit(radiobuf[radnum],LOWER_NAV1)) {
+    if(panel_test(radioword[radnum], LOWER_NAV1)) {
       loseldis[radnum] = 3;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+        if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
           lonav1dbncfninc[radnum]++;
           if (lonav1dbncfninc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyFineUp);
 	    lonav1dbncfninc[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+        if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
 	  lonav1dbncfndec[radnum]++;
           if (lonav1dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyFineDn);
 	    lonav1dbncfndec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
 	  lonav1dbnccorinc[radnum]++;
           if (lonav1dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyCorseUp);
 	    lonav1dbnccorinc[radnum] = 0;
 	  }
         }  
-        if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
 	  lonav1dbnccordec[radnum]++;
           if (lonav1dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav1StbyCorseDn);
@@ -2186,7 +2205,7 @@ void process_lower_nav1_switch()
 	  }
         }
 
-	if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+	if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
 	  XPLMCommandOnce(Nav1ActStby);
         }
       } 
@@ -2204,38 +2223,38 @@ void process_lower_nav2_switch()
 
 
 
-    if(testbit(radiobuf[radnum],LOWER_NAV2)) {
+    if(panel_test(radioword[radnum], LOWER_NAV2)) {
       loseldis[radnum] = 4;
       if (radiores > 0) {
-        if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+        if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
           lonav2dbncfninc[radnum]++;
           if (lonav2dbncfninc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyFineUp);
 	    lonav2dbncfninc[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+        if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
 	  lonav2dbncfndec[radnum]++;
           if (lonav2dbncfndec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyFineDn);
 	    lonav2dbncfndec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+        if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
 	  lonav2dbnccorinc[radnum]++;
           if (lonav2dbnccorinc[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyCorseUp);
 	    lonav2dbnccorinc[radnum] = 0;
 	  }
         }  
-        if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+        if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
 	  lonav2dbnccordec[radnum]++;
           if (lonav2dbnccordec[radnum] > radspeed) {
 	    XPLMCommandOnce(Nav2StbyCorseDn);
 	    lonav2dbnccordec[radnum] = 0;
 	  }
         }
-        if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+        if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
 	  XPLMCommandOnce(Nav2ActStby);
         }
       }
@@ -2251,19 +2270,19 @@ void process_lower_nav2_switch()
 void process_lower_adf_switch()
 {
 
-    if(testbit(radiobuf[radnum],LOWER_ADF)) {
+    if(panel_test(radioword[radnum], LOWER_ADF)) {
       loseldis[radnum] = 5;
       if (numadf == 1) {
          if (radiores > 0) {
           if (loadfsel[radnum] == 1) {
-            if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
               loadfdbncfninc[radnum]++;
               if (loadfdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyOnesUp);
                 loadfdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
               loadfdbncfndec[radnum]++;
               if (loadfdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyOnesDn);
@@ -2274,14 +2293,14 @@ void process_lower_adf_switch()
 
           }
           if (loadfsel[radnum] == 2) {
-	    if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+	    if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
 	      loadfdbncfninc[radnum]++;
               if (loadfdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyTensUp);
 	        loadfdbncfninc[radnum] = 0;
 	      }
             }
-            if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
               loadfdbncfndec[radnum]++;
               if (loadfdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(Afd1StbyTensDn);
@@ -2291,14 +2310,14 @@ void process_lower_adf_switch()
 
           }
             if (loadfsel[radnum] == 3) {
-              if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+              if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
                 loadfdbncfninc[radnum]++;
                 if (loadfdbncfninc[radnum] > radspeed) {
                   XPLMCommandOnce(Afd1StbyHunUp);
                   loadfdbncfninc[radnum] = 0;
                 }
               }
-              if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+              if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
                 loadfdbncfndec[radnum]++;
                 if (loadfdbncfndec[radnum] > radspeed) {
                   XPLMCommandOnce(Afd1StbyHunDn);
@@ -2308,7 +2327,7 @@ void process_lower_adf_switch()
           }
 
   // Use the Coarse knob to select digit in the up direction
-          if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+          if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
             loadfdbnccorinc[radnum] ++;
             if(loadfdbnccorinc[radnum] == 3) {
               loadfsel[radnum] ++;
@@ -2319,7 +2338,7 @@ void process_lower_adf_switch()
             }
           }
   // Use the Coarse knob to select digit in the down direction
-          if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+          if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
             loadfdbnccordec[radnum] ++;
             if(loadfdbnccordec[radnum] == 3) {
               loadfsel[radnum] --;
@@ -2330,7 +2349,7 @@ void process_lower_adf_switch()
             }
           }
 
-          if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+          if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
             XPLMCommandOnce(Adf1ActStby);
           }
          }
@@ -2343,14 +2362,14 @@ void process_lower_adf_switch()
       if (numadf == 2) {
         if (radiores > 0) {
           if (loadfsel[radnum] == 1) {
-            if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
               loadfdbncfninc[radnum]++;
               if (loadfdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(Afd2StbyOnesUp);
                 loadfdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
               loadfdbncfndec[radnum]++;
               if (loadfdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(Afd2StbyOnesDn);
@@ -2361,14 +2380,14 @@ void process_lower_adf_switch()
 
           }
           if (loadfsel[radnum] == 2) {
-            if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
               loadfdbncfninc[radnum]++;
               if (loadfdbncfninc[radnum] > radspeed) {
                 XPLMCommandOnce(Afd2StbyTensUp);
                 loadfdbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
               loadfdbncfndec[radnum]++;
               if (loadfdbncfndec[radnum] > radspeed) {
                 XPLMCommandOnce(Afd2StbyTensDn);
@@ -2377,14 +2396,14 @@ void process_lower_adf_switch()
             }
           }
             if (loadfsel[radnum] == 3) {
-              if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+              if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
                 loadfdbncfninc[radnum]++;
                 if (loadfdbncfninc[radnum] > radspeed) {
                   XPLMCommandOnce(Afd2StbyHunUp);
                   loadfdbncfninc[radnum] = 0;
                 }
               }
-              if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+              if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
                 loadfdbncfndec[radnum]++;
                 if (loadfdbncfndec[radnum] > radspeed) {
                   XPLMCommandOnce(Afd2StbyHunDn);
@@ -2395,7 +2414,7 @@ void process_lower_adf_switch()
           }
 
   // Use the Coarse knob to select digit in the up direction
-            if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
               loadfdbnccorinc[radnum] ++;
               if(loadfdbnccorinc[radnum] > radspeed) {
                 loadfsel[radnum] ++;
@@ -2407,7 +2426,7 @@ void process_lower_adf_switch()
             }
 
    // Use the Coarse knob to select digit in the down direction
-            if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+            if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
               loadfdbnccordec[radnum] ++;
               if(loadfdbnccordec[radnum] > radspeed) {
                 loadfsel[radnum] --;
@@ -2418,7 +2437,7 @@ void process_lower_adf_switch()
               }
             }
 
-            if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+            if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
               XPLMCommandOnce(Adf2ActStby);
             }
 
@@ -2436,14 +2455,14 @@ void process_lower_adf_switch()
 void process_lower_dme_switch()
 {
 
-    if(testbit(radiobuf[radnum],LOWER_DME)) {
+    if(panel_test(radioword[radnum], LOWER_DME)) {
 
       // ****** Function button is not pushed  *******
       if(xpanelsfnbutton == 0) {
 
         if (lodmepushed == 0) {
           if (XPLMGetDatai(DmeMode) == 0) {
-             if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                 XPLMSetDatai(DmeMode, 1);
                 lodmepushed = 1;
                 lolastdmepos = 1;
@@ -2453,7 +2472,7 @@ void process_lower_dme_switch()
 
         if (lodmepushed == 0) {
           if (XPLMGetDatai(DmeMode) == 1) {
-             if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                 XPLMSetDatai(DmeMode, 2);
                 lodmepushed = 1;
                 if (lolastdmepos == 2){
@@ -2466,7 +2485,7 @@ void process_lower_dme_switch()
 
         if (lodmepushed == 0) {
           if (XPLMGetDatai(DmeMode) == 2) {
-              if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+              if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                  XPLMSetDatai(DmeMode, 1);
                  lodmepushed = 1;
                  lolastdmepos = 2;
@@ -2509,7 +2528,7 @@ void process_lower_dme_switch()
             lodmefreq[radnum] = XPLMGetDatai(DmeFreq);
             lodmefreqhnd = lodmefreq[radnum]/100;
             lodmefreqfrc = lodmefreq[radnum]%100;
-            if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
               if (lodmefreqfrc == 95) {
                   lodmefreqfrc = 0;
               }
@@ -2519,7 +2538,7 @@ void process_lower_dme_switch()
                 lodmedbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
               if (lodmefreqfrc == 0) {
                   lodmefreqfrc = 95;
               }
@@ -2530,7 +2549,7 @@ void process_lower_dme_switch()
               }
             }
 
-            if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+            if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
               if (lodmefreqhnd == 117) {
                   lodmefreqhnd = 108;
               }
@@ -2540,7 +2559,7 @@ void process_lower_dme_switch()
                 lodmedbncfninc[radnum] = 0;
               }
             }
-            if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+            if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
               if (lodmefreqhnd == 108) {
                   lodmefreqhnd = 117;
               }
@@ -2572,7 +2591,7 @@ void process_lower_dme_switch()
 
           if (lodmepushed == 0) {
             if (XPLMGetDatai(DmeSlvSource) == 0) {
-               if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+               if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                   XPLMSetDatai(DmeSlvSource, 1);
                   lodmepushed = 1;
                   lolastdmepos = 0;
@@ -2582,7 +2601,7 @@ void process_lower_dme_switch()
 
           if (lodmepushed == 0) {
             if (XPLMGetDatai(DmeSlvSource) == 1) {
-               if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+               if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                   XPLMSetDatai(DmeSlvSource, 0);
                   lodmepushed = 1;
 
@@ -2613,20 +2632,20 @@ void process_lower_xpdr_switch()
 
 
  
-   if(testbit(radiobuf[radnum],LOWER_XPDR)) {
+   if(panel_test(radioword[radnum], LOWER_XPDR)) {
      loseldis[radnum] = 9;
 
 // ****** Function button is not pushed  *******
        if(xpanelsfnbutton == 0) {
          if (loxpdrsel[radnum] == 1) {
-           if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
              loxpdrdbncfninc[radnum]++;
              if (loxpdrdbncfninc[radnum] > radspeed) {
                XPLMCommandOnce(XpdrOnesUp);
                loxpdrdbncfninc[radnum] = 0;
              }
            }
-           if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
              loxpdrdbncfndec[radnum]++;
              if (loxpdrdbncfndec[radnum] > radspeed) {
                XPLMCommandOnce(XpdrOnesDn);
@@ -2635,14 +2654,14 @@ void process_lower_xpdr_switch()
            }
          }
          if (loxpdrsel[radnum] == 2) {
-           if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
 	     loxpdrdbncfninc[radnum]++;
              if (loxpdrdbncfninc[radnum] > radspeed) {
                XPLMCommandOnce(XpdrTensUp);
 	       loxpdrdbncfninc[radnum] = 0;
 	     }
            }
-           if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
 	     loxpdrdbncfndec[radnum]++;
              if (loxpdrdbncfndec[radnum] > radspeed) {
                XPLMCommandOnce(XpdrTensDn);
@@ -2653,14 +2672,14 @@ void process_lower_xpdr_switch()
 	 }
 
          if (loxpdrsel[radnum] == 3) {
-           if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
              loxpdrdbncfninc[radnum]++;
              if (loxpdrdbncfninc[radnum] > radspeed) {
                XPLMCommandOnce(XpdrHunUp);
                loxpdrdbncfninc[radnum] = 0;
              }
            }
-           if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
              loxpdrdbncfndec[radnum]++;
              if (loxpdrdbncfndec[radnum] > radspeed) {
                XPLMCommandOnce(XpdrHunDn);
@@ -2671,14 +2690,14 @@ void process_lower_xpdr_switch()
          }
 
          if (loxpdrsel[radnum] == 4) {
-           if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
              loxpdrdbncfninc[radnum]++;
              if (loxpdrdbncfninc[radnum] > radspeed) {
                XPLMCommandOnce(XpdrThUp);
                loxpdrdbncfninc[radnum] = 0;
              }
            }
-           if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+           if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
              loxpdrdbncfndec[radnum]++;
              if (loxpdrdbncfndec[radnum] > radspeed) {
                XPLMCommandOnce(XpdrThDn);
@@ -2689,7 +2708,7 @@ void process_lower_xpdr_switch()
          }
 
 // Use the Coarse knob to select digit in the up direction
-         if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+         if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
            loxpdrdbnccorinc[radnum]++;
            if(loxpdrdbnccorinc[radnum] > radspeed) {
               loxpdrsel[radnum] ++;
@@ -2701,7 +2720,7 @@ void process_lower_xpdr_switch()
            }
          }
 // Use the Coarse knob to select digit in the up direction
-         if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+         if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
            loxpdrdbnccordec[radnum]++;
            if(loxpdrdbnccordec[radnum] > radspeed) {
               loxpdrsel[radnum] --;
@@ -2718,7 +2737,7 @@ void process_lower_xpdr_switch()
 
          if (loxpdrpushed == 0) {
            if (XPLMGetDatai(XpdrMode) == 0) {
-             if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                XPLMSetDatai(XpdrMode, 1);
                loxpdrpushed = 1;
                lolastxpdrpos = 0;
@@ -2728,7 +2747,7 @@ void process_lower_xpdr_switch()
 
          if (loxpdrpushed == 0) {
            if (XPLMGetDatai(XpdrMode) == 1) {
-             if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                if (lolastxpdrpos == 0){
                  XPLMSetDatai(XpdrMode, 2);
                  loxpdrpushed = 1;
@@ -2743,7 +2762,7 @@ void process_lower_xpdr_switch()
          }
          if (loxpdrpushed == 0) {
            if (XPLMGetDatai(XpdrMode) == 2) {
-             if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                if (lolastxpdrpos == 1){
                  XPLMSetDatai(XpdrMode, 3);
                  loxpdrpushed = 1;
@@ -2760,7 +2779,7 @@ void process_lower_xpdr_switch()
 
          if (loxpdrpushed == 0) {
            if (XPLMGetDatai(XpdrMode) == 3) {
-             if(testbit(radiobuf[radnum], LOWER_ACT_STBY)) {
+             if(panel_test(radioword[radnum],  LOWER_ACT_STBY)) {
                XPLMSetDatai(XpdrMode, 2);
                loxpdrpushed = 1;
                lolastxpdrpos = 3;
@@ -2782,14 +2801,14 @@ void process_lower_xpdr_switch()
 
  // ****** Function button is pushed  *******
         if(xpanelsfnbutton == 1) {
-          if(testbit(radiobuf[radnum],LOWER_FINE_UP)) {
+          if(panel_test(radioword[radnum], LOWER_FINE_UP)) {
             loqnhdbncfninc[radnum]++;
             if (loqnhdbncfninc[radnum] > radspeed) {
               XPLMCommandOnce(BaroUp);
               loqnhdbncfninc[radnum] = 0;
             }
           }
-          if(testbit(radiobuf[radnum],LOWER_FINE_DN)) {
+          if(panel_test(radioword[radnum], LOWER_FINE_DN)) {
             loqnhdbncfndec[radnum]++;
             if (loqnhdbncfndec[radnum] > radspeed) {
               XPLMCommandOnce(BaroDn);
@@ -2797,7 +2816,7 @@ void process_lower_xpdr_switch()
             }
           }
 
-          if(testbit(radiobuf[radnum],LOWER_COARSE_UP)) {
+          if(panel_test(radioword[radnum], LOWER_COARSE_UP)) {
             loqnhdbnccorinc[radnum]++;
             if (loqnhdbnccorinc[radnum] > radspeed) {
               radn = 10;
@@ -2808,7 +2827,7 @@ void process_lower_xpdr_switch()
               loqnhdbnccorinc[radnum] = 0;
             }
           }
-          if(testbit(radiobuf[radnum],LOWER_COARSE_DN)) {
+          if(panel_test(radioword[radnum], LOWER_COARSE_DN)) {
             loqnhdbnccordec[radnum]++;
             if (loqnhdbnccordec[radnum] > radspeed) {
                 radn = 10;
@@ -2819,7 +2838,7 @@ void process_lower_xpdr_switch()
                 loqnhdbnccordec[radnum] = 0;
             }
           }
-          if(testbit(radiobuf[radnum],LOWER_ACT_STBY)) {
+          if(panel_test(radioword[radnum], LOWER_ACT_STBY)) {
             XPLMCommandOnce(BaroStd);
           }
 
@@ -2848,12 +2867,7 @@ void process_radio_blank_display()
 {
 
 
-	if (XPLMGetDatai(AvPwrOn) == 0) {
-          upseldis[radnum] = 10;
-          loseldis[radnum] = 10;
-	}
-
-	if (XPLMGetDatai(BatPwrOn) == 0) {
+	if ((buspower & BUS_POWER_DISPLAYS) != BUS_POWER_DISPLAYS) {
           upseldis[radnum] = 10;
           loseldis[radnum] = 10;
 	}
@@ -2949,6 +2963,9 @@ void process_radio_panel1()
   int radio_safety_cntr = 30;
   do{
     radiores = hid_read(radiohandle[radnum], radiobuf[radnum], sizeof(radiobuf[radnum]));
+    if (radiores > 0) {
+        radioword[radnum] = panel_report_word(radiobuf[radnum]);
+    }
 
     process_upper_com1_switch();
     process_upper_com2_switch();
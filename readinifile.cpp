@@ -46,6 +46,261 @@ string convert_Mac_Path(string in_path) {
     return in_path;
 }
 
+// ***** Remap Command Binding ******
+// Every remapable command is resolved here once per ini read. A command
+// that X-Plane does not know is bound to our own do-nothing command, so a
+// NULL handle never reaches XPLMCommandOnce, and all failures are reported
+// in one summary line.
+static int remapbound = 0, remapunbound = 0;
+static string remapmissing;
+
+static XPLMCommandRef bind_remap_name(const char *key, const char *cmdname)
+{
+    XPLMCommandRef cmd;
+
+    cmd = XPLMFindCommand(cmdname);
+    if (cmd == NULL) {
+        remapunbound++;
+        remapmissing.append(" ");
+        remapmissing.append(key);
+        remapmissing.append("=");
+        remapmissing.append(cmdname);
+        return XpanelsUnboundRemapCommand;
+    }
+    remapbound++;
+    return cmd;
+}
+
+XPLMCommandRef bind_remap_command(const char *key, string &cmdname)
+{
+    cmdname = getOptionToString(key);
+    return bind_remap_name(key, cmdname.c_str());
+}
+
+void process_remap_summary()
+{
+    char remap_summary_buffer[128];
+
+    if ((remapbound + remapunbound) == 0) {
+        return;
+    }
+    sprintf(remap_summary_buffer, "Xsaitekpanels: %d remap commands bound, %d not found", remapbound, remapunbound);
+    XPLMDebugString(remap_summary_buffer);
+    if (remapunbound > 0) {
+        XPLMDebugString(":");
+        XPLMDebugString(remapmissing.c_str());
+    }
+    XPLMDebugString("\n");
+}
+
+// ***** Switch Panel Profiles ******
+// The switch keys are picked out of the parsed ini in one pass and resolved
+// into the spare SwitchProfileSet, which is then published whole. Switch
+// panels after the first read the same keys with a prefix, for example
+// "Switch2 Mag Off Switch enable" and "switch2_mag_off_switch_on_cmd", and
+// follow the first panel for anything they leave out.
+static const char *switchprofilekeys[SWITCH_ITEM_COUNT][3] = {
+    {"Mag Off Switch enable",          "mag_off_switch_on_cmd",         "mag_off_switch_off_cmd"},
+    {"Mag Right Switch enable",        "mag_right_switch_on_cmd",       "mag_right_switch_off_cmd"},
+    {"Mag Left Switch enable",         "mag_left_switch_on_cmd",        "mag_left_switch_off_cmd"},
+    {"Mag Both Switch enable",         "mag_both_switch_on_cmd",        "mag_both_switch_off_cmd"},
+    {"Mag Start Switch enable",        "mag_start_switch_on_cmd",       "mag_start_switch_off_cmd"},
+    {"Bat Master Switch enable",       "bat_master_switch_on_cmd",      "bat_master_switch_cmd"},
+    {"Alt Master Switch enable",       "alt_master_switch_on_cmd",      "alt_master_switch_off_cmd"},
+    {"Avionics master Switch enable",  "av_master_switch_on_cmd",       "av_master_switch_off_cmd"},
+    {"Fuel Pump Switch enable",        "fuel_pump_switch_on_cmd",       "fuel_pump_switch_off_cmd"},
+    {"Deice Switch enable",            "deice_switch_on_cmd",           "deice_switch_off_cmd"},
+    {"Pitot Heat Switch enable",       "pitot_heat_switch_on_cmd",      "pitot_heat_switch_off_cmd"},
+    {"Landing Gear Knob Up enable",    "gear_up_switch_up_cmd",         "gear_up_switch_down_cmd"},
+    {"Cowl Flaps enable",              "cowl_flaps_open_cmd",           "cowl_flaps_close_cmd"},
+    {"Panel Lights Switch enable",     "panel_lights_switch_on_cmd",    "panel_lights_switch_off_cmd"},
+    {"Beacon Lights Switch enable",    "beacon_lights_switch_on_cmd",   "beacon_lights_switch_off_cmd"},
+    {"Nav Lights Switch enable",       "nav_lights_switch_on_cmd",      "nav_lights_switch_off_cmd"},
+    {"Strobe Lights Switch enable",    "strobe_lights_switch_on_cmd",   "strobe_lights_switch_off_cmd"},
+    {"Taxi Lights Switch enable",      "taxi_lights_switch_on_cmd",     "taxi_lights_switch_off_cmd"},
+    {"Landing Lights Switch enable",   "landing_lights_switch_on_cmd",  "landing_lights_switch_off_cmd"}
+};
+
+// * the gear down row of the widget has its own commands, they win when given *
+static const char *switchgeardnkeys[2] = {"gear_dn_switch_up_cmd", "gear_dn_switch_down_cmd"};
+
+// * ini item index of every switch key for one panel, -1 when not given *
+struct SwitchProfileKeys {
+    int item[SWITCH_ITEM_COUNT][3];
+    int geardn[2];
+    int bataltinverse;
+};
+
+static int switch_key_panel(const char *key, const char **rest)
+{
+    if (((strncmp(key, "Switch", 6) == 0) || (strncmp(key, "switch", 6) == 0)) &&
+        (key[6] >= '2') && (key[6] < '1' + SWITCH_PANEL_MAX) &&
+        ((key[7] == ' ') || (key[7] == '_'))) {
+        *rest = key + 8;
+        return key[6] - '1';
+    }
+    *rest = key;
+    return 0;
+}
+
+// * the first time a key is given is the one used, like getOptionToString *
+static void switch_key_match(SwitchProfileKeys *keys, const char *rest, int n)
+{
+    int item, field;
+
+    if (strcmp(rest, "Bat Alt inverse") == 0) {
+        if (keys->bataltinverse < 0) {
+            keys->bataltinverse = n;
+        }
+        return;
+    }
+    for (field = 0; field < 2; field++) {
+        if (strcmp(rest, switchgeardnkeys[field]) == 0) {
+            if (keys->geardn[field] < 0) {
+                keys->geardn[field] = n;
+            }
+            return;
+        }
+    }
+    for (item = 0; item < SWITCH_ITEM_COUNT; item++) {
+        for (field = 0; field < 3; field++) {
+            if (strcmp(rest, switchprofilekeys[item][field]) == 0) {
+                if (keys->item[item][field] < 0) {
+                    keys->item[item][field] = n;
+                }
+                return;
+            }
+        }
+    }
+}
+
+static int switch_key_int(int n, int missing)
+{
+    if (n < 0) {
+        return missing;
+    }
+    return atoi(getOptionValue(n).c_str());
+}
+
+static int switch_key_given(int n)
+{
+    return (n >= 0) && !getOptionValue(n).empty();
+}
+
+// * a missing command key is still reported, under its plain name *
+static XPLMCommandRef switch_key_command(int n, const char *key)
+{
+    if (n < 0) {
+        return bind_remap_name(key, "");
+    }
+    return bind_remap_name(getOptionKey(n).c_str(), getOptionValue(n).c_str());
+}
+
+static void switch_profile_commands(SwitchProfile *profile, SwitchProfileKeys *keys, int item)
+{
+    int on = keys->item[item][1], off = keys->item[item][2];
+
+    if ((item == SWITCH_ITEM_GEAR) && switch_key_given(keys->geardn[0])) {
+        on = keys->geardn[0];
+    }
+    if ((item == SWITCH_ITEM_GEAR) && switch_key_given(keys->geardn[1])) {
+        off = keys->geardn[1];
+    }
+    profile->oncmd[item] = switch_key_command(on, switchprofilekeys[item][1]);
+    profile->offcmd[item] = switch_key_command(off, switchprofilekeys[item][2]);
+}
+
+// * the widget shows the first panel, its gear down row follows the gear knob *
+static void process_switch_profile_widgets(const SwitchProfile *first)
+{
+    int widget, item, enable;
+
+    if (first->bataltinverse == 0) {
+        XPSetWidgetProperty(SwitchBatAltCheckWidget[0], xpProperty_ButtonState, 1);
+        XPSetWidgetProperty(SwitchAltBatCheckWidget[0], xpProperty_ButtonState, 0);
+    }
+    if (first->bataltinverse == 1) {
+        XPSetWidgetProperty(SwitchBatAltCheckWidget[0], xpProperty_ButtonState, 0);
+        XPSetWidgetProperty(SwitchAltBatCheckWidget[0], xpProperty_ButtonState, 1);
+    }
+
+    for (widget = 0; widget <= SWITCH_ITEM_WIDGET(SWITCH_ITEM_COUNT - 1); widget++) {
+        if (widget == SWITCH_WIDGET_GEAR_DN) {
+            item = SWITCH_ITEM_GEAR;
+        } else {
+            item = (widget < SWITCH_WIDGET_GEAR_DN) ? widget : widget - 1;
+        }
+        enable = first->enable[item];
+        XPSetWidgetProperty(SwitchDisableCheckWidget[widget], xpProperty_ButtonState, enable == 0);
+        XPSetWidgetProperty(SwitchEnableCheckWidget[widget], xpProperty_ButtonState, enable == 1);
+        XPSetWidgetProperty(SwitchRemapCheckWidget[widget], xpProperty_ButtonState, enable == 2);
+    }
+}
+
+void process_read_switch_profiles()
+{
+    SwitchProfileKeys keys[SWITCH_PANEL_MAX];
+    SwitchProfileSet *set = switch_profile_defaults(switch_profile_spare());
+    SwitchProfile *first = &set->panel[0];
+    const char *rest;
+    int count = getOptionCount();
+    int n, panel, item;
+
+    if (count == 0) {
+        switch_profile_publish(set);
+        return;
+    }
+
+    memset(keys, 0xff, sizeof(keys));
+    for (n = 0; n < count; n++) {
+        panel = switch_key_panel(getOptionKey(n).c_str(), &rest);
+        switch_key_match(&keys[panel], rest, n);
+    }
+
+    // * first panel, a key the ini leaves out reads as 0 *
+    first->bataltinverse = switch_key_int(keys[0].bataltinverse, 0);
+    for (item = 0; item < SWITCH_ITEM_COUNT; item++) {
+        first->enable[item] = switch_key_int(keys[0].item[item][0], 0);
+        if (first->enable[item] == 2) {
+            switch_profile_commands(first, &keys[0], item);
+        }
+    }
+
+    // * the others, anything left out is copied from the first panel *
+    for (panel = 1; panel < SWITCH_PANEL_MAX; panel++) {
+        SwitchProfile *profile = &set->panel[panel];
+        SwitchProfileKeys *own = &keys[panel];
+
+        profile->inherited = 0;
+        profile->bataltinverse = switch_key_int(own->bataltinverse, first->bataltinverse);
+        if (own->bataltinverse < 0) {
+            profile->inherited |= 1u << SWITCH_ITEM_COUNT;
+        }
+        for (item = 0; item < SWITCH_ITEM_COUNT; item++) {
+            profile->oncmd[item] = first->oncmd[item];
+            profile->offcmd[item] = first->offcmd[item];
+            if (own->item[item][0] < 0) {
+                profile->enable[item] = first->enable[item];
+                profile->inherited |= 1u << item;
+                continue;
+            }
+            profile->enable[item] = switch_key_int(own->item[item][0], 0);
+            if (profile->enable[item] != 2) {
+                continue;
+            }
+            if (switch_key_given(own->item[item][1])) {
+                profile->oncmd[item] = switch_key_command(own->item[item][1], switchprofilekeys[item][1]);
+            }
+            if (switch_key_given(own->item[item][2])) {
+                profile->offcmd[item] = switch_key_command(own->item[item][2], switchprofilekeys[item][2]);
+            }
+        }
+    }
+
+    process_switch_profile_widgets(first);
+    switch_profile_publish(set);
+}
+
 // ***** Configuration File Process ******
 void process_read_ini_file()
 
@@ -56,36 +311,9 @@ void process_read_ini_file()
 
     iniDefaultPluginPath = "./Resources/plugins/Xsaitekpanels/xsaitekpanels.ini";
     //defaultConfigFileName = "xsaitekpanels.ini";
-    int Index2;
 
     /* set defaults */
 
-    // switch panel defaults
-
-    // switches
-    magoffswitchenable           = 1;
-    magrightswitchenable         = 1;
-    magleftswitchenable          = 1;
-    magbothswitchenable          = 1;
-    magstartswitchenable         = 1;
-    batmasterswitchenable        = 1;
-    altmasterswitchenable        = 1;
-    avionicsmasterswitchenable   = 1;
-    fuelpumpswitchenable         = 1;
-    deiceswitchenable            = 1;
-    pitotheatswitchenable        = 1;
-    landinggearknobupenable      = 1;
-    landinggearknobdnenable      = 1;
-    cowlflapsenable              = 1;
-    panellightswitchenable       = 1;
-    beaconlightswitchenable      = 1;
-    navlightswitchenable         = 1;
-    strobelightswitchenable      = 1;
-    taxilightswitchenable        = 1;
-    landinglightswitchenable     = 1;
-
-    bataltinverse = 0;
-
     // radio panel
     radspeed                 = 3;
     numadf                   = 1;
@@ -107,6 +335,10 @@ void process_read_ini_file()
 
     //char *configPath;
 
+    remapbound = 0;
+    remapunbound = 0;
+    remapmissing.clear();
+
     cleanupIniReader();
 
     char xpsacfname[512];
@@ -118,6 +350,7 @@ void process_read_ini_file()
     //XPLMDebugString("\n");
 
     if(strlen(xpsacfpath) == 0){
+      process_read_switch_profiles();
       return;
     }
 
@@ -160,408 +393,13 @@ void process_read_ini_file()
            parseIniFile(iniDefaultPluginPath);
 
        } else {
+           process_read_switch_profiles();
            return;
        }
     }
 
-    // bat alt normal alt bat cessna
-    bataltinverse = getOptionToInt("Bat Alt inverse");
-    if (bataltinverse == 0) {
-        XPSetWidgetProperty(SwitchBatAltCheckWidget[0], xpProperty_ButtonState, 1);
-        XPSetWidgetProperty(SwitchAltBatCheckWidget[0], xpProperty_ButtonState, 0);
-
-    }
-
-    if (bataltinverse == 1) {
-        XPSetWidgetProperty(SwitchBatAltCheckWidget[0], xpProperty_ButtonState, 0);
-        XPSetWidgetProperty(SwitchAltBatCheckWidget[0], xpProperty_ButtonState, 1);
-
-    }
-
-    for (Index2=0; Index2 < 19; Index2++)
-    {
-        XPSetWidgetProperty(SwitchDisableCheckWidget[Index2], xpProperty_ButtonState, 0);
-        XPSetWidgetProperty(SwitchEnableCheckWidget[Index2], xpProperty_ButtonState, 0);
-        XPSetWidgetProperty(SwitchRemapCheckWidget[Index2], xpProperty_ButtonState, 0);
-    }
-
-    // mag off switch disable - enable - remap
-    magoffswitchenable = getOptionToInt("Mag Off Switch enable");
-    if (magoffswitchenable == 0) {
-        XPSetWidgetProperty(SwitchDisableCheckWidget[0], xpProperty_ButtonState, 1);
-    }
-
-    if (magoffswitchenable == 1) {
-        XPSetWidgetProperty(SwitchEnableCheckWidget[0], xpProperty_ButtonState, 1);
-    }
-
-    if (magoffswitchenable == 2) {
-        XPSetWidgetProperty(SwitchRemapCheckWidget[0], xpProperty_ButtonState, 1);
-        mag_off_switch_on = getOptionToString("mag_off_switch_on_cmd");
-        mag_off_switch_off = getOptionToString("mag_off_switch_off_cmd");
-        MagOffSwitchOnCmd   = XPLMFindCommand(mag_off_switch_on.c_str());
-        MagOffSwitchOffCmd   = XPLMFindCommand(mag_off_switch_off.c_str());
-     }
-
-    // mag right switch disable - enable - remap
-    magrightswitchenable = getOptionToInt("Mag Right Switch enable");
-    if (magrightswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[1], xpProperty_ButtonState, 1);
-    }
-
-    if (magrightswitchenable == 1) {
-            XPSetWidgetProperty(SwitchEnableCheckWidget[1], xpProperty_ButtonState, 1);
-    }
-
-    if (magrightswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[1], xpProperty_ButtonState, 1);
-            mag_right_switch_on = getOptionToString("mag_right_switch_on_cmd");
-            mag_right_switch_off = getOptionToString("mag_right_switch_off_cmd");
-            MagRightSwitchOnCmd   = XPLMFindCommand(mag_right_switch_on.c_str());
-            MagRightSwitchOffCmd   = XPLMFindCommand(mag_right_switch_off.c_str());
-    }
-
-    // mag left switch disable - enable - remap
-    magleftswitchenable = getOptionToInt("Mag Left Switch enable");
-    if (magleftswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[2], xpProperty_ButtonState, 1);
-    }
-
-    if (magleftswitchenable == 1) {
-            XPSetWidgetProperty(SwitchEnableCheckWidget[2], xpProperty_ButtonState, 1);
-    }
-
-    if (magleftswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[2], xpProperty_ButtonState, 1);
-            mag_left_switch_on = getOptionToString("mag_left_switch_on_cmd");
-            mag_left_switch_off = getOptionToString("mag_left_switch_off_cmd");
-            MagLeftSwitchOnCmd   = XPLMFindCommand(mag_left_switch_on.c_str());
-            MagLeftSwitchOffCmd   = XPLMFindCommand(mag_left_switch_off.c_str());
-    }
-
-    // mag both switch disable - enable - remap
-    magbothswitchenable = getOptionToInt("Mag Both Switch enable");
-    if (magbothswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[3], xpProperty_ButtonState, 1);
-    }
-
-    if (magbothswitchenable == 1) {
-
-            XPSetWidgetProperty(SwitchEnableCheckWidget[3], xpProperty_ButtonState, 1);
-    }
-
-    if (magbothswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[3], xpProperty_ButtonState, 1);
-            mag_both_switch_on = getOptionToString("mag_both_switch_on_cmd");
-            mag_both_switch_off = getOptionToString("mag_both_switch_off_cmd");
-            MagBothSwitchOnCmd   = XPLMFindCommand(mag_both_switch_on.c_str());
-            MagBothSwitchOffCmd   = XPLMFindCommand(mag_both_switch_off.c_str());
-    }
-
-    // mag start switch disable - enable - remap
-    magstartswitchenable = getOptionToInt("Mag Start Switch enable");
-    if (magstartswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[4], xpProperty_ButtonState, 1);
-    }
-
-    if (magstartswitchenable == 1) {
-             XPSetWidgetProperty(SwitchEnableCheckWidget[4], xpProperty_ButtonState, 1);
-      }
-
-    if (magstartswitchenable == 2) {
-
-            XPSetWidgetProperty(SwitchRemapCheckWidget[4], xpProperty_ButtonState, 1);
-            mag_start_switch_on = getOptionToString("mag_start_switch_on_cmd");
-            mag_start_switch_off = getOptionToString("mag_start_switch_off_cmd");
-            MagStartSwitchOnCmd   = XPLMFindCommand(mag_start_switch_on.c_str());
-            MagStartSwitchOffCmd   = XPLMFindCommand(mag_start_switch_off.c_str());
-    }
-
-    // bat master switch disable - enable - remap
-    batmasterswitchenable = getOptionToInt("Bat Master Switch enable");
-    if (batmasterswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[5], xpProperty_ButtonState, 1);
-    }
-
-    if (batmasterswitchenable == 1) {
-            XPSetWidgetProperty(SwitchEnableCheckWidget[5], xpProperty_ButtonState, 1);
-    }
-
-    if (batmasterswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[5], xpProperty_ButtonState, 1);
-            bat_master_switch_on = getOptionToString("bat_master_switch_on_cmd");
-            bat_master_switch_off = getOptionToString("bat_master_switch_cmd");
-            BatMasterSwitchOnCmd   = XPLMFindCommand(bat_master_switch_on.c_str());
-            BatMasterSwitchOffCmd   = XPLMFindCommand(bat_master_switch_off.c_str());
-    }
-
-
-    // alt master switch disable - enable - remap
-    altmasterswitchenable = getOptionToInt("Alt Master Switch enable");
-    if (altmasterswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[6], xpProperty_ButtonState, 1);
-
-    }
-
-    if (altmasterswitchenable == 1) {
-            XPSetWidgetProperty(SwitchEnableCheckWidget[6], xpProperty_ButtonState, 1);
-     }
-
-    if (altmasterswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[6], xpProperty_ButtonState, 1);
-            alt_master_switch_on = getOptionToString("alt_master_switch_on_cmd");
-            alt_master_switch_off = getOptionToString("alt_master_switch_off_cmd");
-            AltMasterSwitchOnCmd   = XPLMFindCommand(alt_master_switch_on.c_str());
-            AltMasterSwitchOffCmd   = XPLMFindCommand(alt_master_switch_off.c_str());
-    }
-
-    // avionics master switch disable - enable - remap
-    avionicsmasterswitchenable = getOptionToInt("Avionics master Switch enable");
-    if (avionicsmasterswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[7], xpProperty_ButtonState, 1);
-    }
-
-    if (avionicsmasterswitchenable == 1) {
-            XPSetWidgetProperty(SwitchEnableCheckWidget[7], xpProperty_ButtonState, 1);
-    }
-
-    if (avionicsmasterswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[7], xpProperty_ButtonState, 1);
-            av_master_switch_on = getOptionToString("av_master_switch_on_cmd");
-            av_master_switch_off = getOptionToString("av_master_switch_off_cmd");
-            AvMasterSwitchOnCmd   = XPLMFindCommand(av_master_switch_on.c_str());
-            AvMasterSwitchOffCmd   = XPLMFindCommand(av_master_switch_off.c_str());
-    }
-
-    // fuel pump switch disable - enable - remap
-    fuelpumpswitchenable = getOptionToInt("Fuel Pump Switch enable");
-    if (fuelpumpswitchenable == 0) {
-        XPSetWidgetProperty(SwitchDisableCheckWidget[8], xpProperty_ButtonState, 1);
-    }
-
-    if (fuelpumpswitchenable == 1) {
-        XPSetWidgetProperty(SwitchEnableCheckWidget[8], xpProperty_ButtonState, 1);
-    }
-
-    if (fuelpumpswitchenable == 2) {
-        XPSetWidgetProperty(SwitchRemapCheckWidget[8], xpProperty_ButtonState, 1);
-        fuel_pump_switch_on = getOptionToString("fuel_pump_switch_on_cmd");
-        fuel_pump_switch_off = getOptionToString("fuel_pump_switch_off_cmd");
-        FuelPumpOnCmd   = XPLMFindCommand(fuel_pump_switch_on.c_str());
-        FuelPumpOffCmd   = XPLMFindCommand(fuel_pump_switch_off.c_str());
-    }
-
-
-
-    // deice switch disable - enable - remap
-    deiceswitchenable = getOptionToInt("Deice Switch enable");
-    if (deiceswitchenable == 0) {
-        XPSetWidgetProperty(SwitchDisableCheckWidget[9], xpProperty_ButtonState, 1);
-    }
-
-    if (deiceswitchenable == 1) {
-        XPSetWidgetProperty(SwitchEnableCheckWidget[9], xpProperty_ButtonState, 1);
-    }
-
-    if (deiceswitchenable == 2) {
-        XPSetWidgetProperty(SwitchRemapCheckWidget[9], xpProperty_ButtonState, 1);
-        deice_switch_on = getOptionToString("deice_switch_on_cmd");
-        deice_switch_off = getOptionToString("deice_switch_off_cmd");
-        DeiceOnCmd   = XPLMFindCommand(deice_switch_on.c_str());
-        DeiceOffCmd   = XPLMFindCommand(deice_switch_off.c_str());
-    }
-
-
-    // pitot heat switch disable - enable - remap
-    pitotheatswitchenable = getOptionToInt("Pitot Heat Switch enable");
-    if (pitotheatswitchenable == 0) {
-        XPSetWidgetProperty(SwitchDisableCheckWidget[10], xpProperty_ButtonState, 1);
-    }
-
-    if (pitotheatswitchenable == 1) {
-        XPSetWidgetProperty(SwitchEnableCheckWidget[10], xpProperty_ButtonState, 1);
-    }
-
-    if (pitotheatswitchenable == 2) {
-        XPSetWidgetProperty(SwitchRemapCheckWidget[10], xpProperty_ButtonState, 1);
-        pitot_heat_switch_on = getOptionToString("pitot_heat_switch_on_cmd");
-        pitot_heat_switch_off = getOptionToString("pitot_heat_switch_off_cmd");
-        PitotHeatOnCmd   = XPLMFindCommand(pitot_heat_switch_on.c_str());
-        PitotHeatOffCmd   = XPLMFindCommand(pitot_heat_switch_off.c_str());
-    }
-
-
-    // landing gear up knob disable - enable - remap
-    landinggearknobupenable = getOptionToInt("Landing Gear Knob Up enable");
-    if (landinggearknobupenable == 0) {
-         XPSetWidgetProperty(SwitchDisableCheckWidget[11], xpProperty_ButtonState, 1);
-     }
-
-     if (landinggearknobupenable == 1) {
-          XPSetWidgetProperty(SwitchEnableCheckWidget[11], xpProperty_ButtonState, 1);
-     }
-
-     if (landinggearknobupenable == 2) {
-         XPSetWidgetProperty(SwitchRemapCheckWidget[11], xpProperty_ButtonState, 1);
-         gear_switch_up = getOptionToString("gear_up_switch_up_cmd");
-         gear_switch_down = getOptionToString("gear_up_switch_down_cmd");
-         GearUpCmd   = XPLMFindCommand(gear_switch_up.c_str());
-         GearDnCmd   = XPLMFindCommand(gear_switch_down.c_str());
-     }
-
-     // landing gear dn knob disable - enable - remap
-     landinggearknobdnenable = getOptionToInt("Landing Gear Knob Up enable");
-     if (landinggearknobdnenable == 0) {
-          XPSetWidgetProperty(SwitchDisableCheckWidget[12], xpProperty_ButtonState, 1);
-      }
-
-      if (landinggearknobdnenable == 1) {
-           XPSetWidgetProperty(SwitchEnableCheckWidget[12], xpProperty_ButtonState, 1);
-       }
-
-      if (landinggearknobdnenable == 2) {
-          XPSetWidgetProperty(SwitchRemapCheckWidget[12], xpProperty_ButtonState, 1);
-          gear_switch_up = getOptionToString("gear_dn_switch_up_cmd");
-          gear_switch_down = getOptionToString("gear_dn_switch_down_cmd");
-          GearUpCmd   = XPLMFindCommand(gear_switch_up.c_str());
-          GearDnCmd   = XPLMFindCommand(gear_switch_down.c_str());
-      }
-
-   // cowl flaps switch disable - enable - remap
-    cowlflapsenable = getOptionToInt("Cowl Flaps enable");
-    if (cowlflapsenable == 0) {
-        XPSetWidgetProperty(SwitchDisableCheckWidget[13], xpProperty_ButtonState, 1);
-   }
-
-    if (cowlflapsenable == 1) {
-        XPSetWidgetProperty(SwitchEnableCheckWidget[13], xpProperty_ButtonState, 1);
-    }
-
-    if (cowlflapsenable == 2) {
-        XPSetWidgetProperty(SwitchRemapCheckWidget[13], xpProperty_ButtonState, 1);
-        cowl_flaps_open = getOptionToString("cowl_flaps_open_cmd");
-        cowl_flaps_close = getOptionToString("cowl_flaps_close_cmd");
-        CowlFlapsOpenCmd   = XPLMFindCommand(cowl_flaps_open.c_str());
-        CowlFlapsCloseCmd   = XPLMFindCommand(cowl_flaps_close.c_str());
-    }
-
-    // panel lights switch disable - enable - remap
-    panellightswitchenable = getOptionToInt("Panel Lights Switch enable");
-    if (panellightswitchenable == 0) {
-         XPSetWidgetProperty(SwitchDisableCheckWidget[14], xpProperty_ButtonState, 1);
-     }
-
-     if (panellightswitchenable == 1) {
-          XPSetWidgetProperty(SwitchEnableCheckWidget[14], xpProperty_ButtonState, 1);
-      }
-
-     if (panellightswitchenable == 2) {
-         XPSetWidgetProperty(SwitchRemapCheckWidget[14], xpProperty_ButtonState, 1);
-         panel_lights_switch_on = getOptionToString("panel_lights_switch_on_cmd");
-         panel_lights_switch_off = getOptionToString("panel_lights_switch_off_cmd");
-         PanelLightsOnCmd   = XPLMFindCommand(panel_lights_switch_on.c_str());
-         PanelLightsOffCmd   = XPLMFindCommand(panel_lights_switch_off.c_str());
-     }
-
-     // beacon lights switch disable - enable - remap
-     beaconlightswitchenable = getOptionToInt("Beacon Lights Switch enable");
-     if (beaconlightswitchenable == 0) {
-          XPSetWidgetProperty(SwitchDisableCheckWidget[15], xpProperty_ButtonState, 1);
-      }
-
-      if (beaconlightswitchenable == 1) {
-          XPSetWidgetProperty(SwitchEnableCheckWidget[15], xpProperty_ButtonState, 1);
-      }
-
-      if (beaconlightswitchenable == 2) {
-          XPSetWidgetProperty(SwitchRemapCheckWidget[15], xpProperty_ButtonState, 1);
-          beacon_lights_switch_on = getOptionToString("beacon_lights_switch_on_cmd");
-          beacon_lights_switch_off = getOptionToString("beacon_lights_switch_off_cmd");
-          BeaconLightsOnCmd   = XPLMFindCommand(beacon_lights_switch_on.c_str());
-          BeaconLightsOffCmd   = XPLMFindCommand(beacon_lights_switch_off.c_str());
-      }
-
-      // nav lights switch disable - enable - remap
-      navlightswitchenable = getOptionToInt("Nav Lights Switch enable");
-      if (navlightswitchenable == 0) {
-           XPSetWidgetProperty(SwitchDisableCheckWidget[16], xpProperty_ButtonState, 1);
-        }
-
-       if (navlightswitchenable == 1) {
-           XPSetWidgetProperty(SwitchEnableCheckWidget[16], xpProperty_ButtonState, 1);
-       }
-
-       if (navlightswitchenable == 2) {
-           XPSetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 1);
-           nav_lights_switch_on = getOptionToString("nav_lights_switch_on_cmd");
-           nav_lights_switch_off = getOptionToString("nav_lights_switch_off_cmd");
-           NavLightsOnCmd   = XPLMFindCommand(nav_lights_switch_on.c_str());
-           NavLightsOffCmd   = XPLMFindCommand(nav_lights_switch_off.c_str());
-       }
-
-       // strobe lights switch disable - enable - remap
-       strobelightswitchenable = getOptionToInt("Strobe Lights Switch enable");
-       if (strobelightswitchenable == 0) {
-            XPSetWidgetProperty(SwitchDisableCheckWidget[17], xpProperty_ButtonState, 1);
-        }
-
-        if (strobelightswitchenable == 1) {
-            XPSetWidgetProperty(SwitchEnableCheckWidget[17], xpProperty_ButtonState, 1);
-        }
-        if (strobelightswitchenable == 2) {
-            XPSetWidgetProperty(SwitchRemapCheckWidget[17], xpProperty_ButtonState, 1);
-            strobe_lights_switch_on = getOptionToString("strobe_lights_switch_on_cmd");
-            strobe_lights_switch_off = getOptionToString("strobe_lights_switch_off_cmd");
-            StrobeLightsOnCmd   = XPLMFindCommand(strobe_lights_switch_on.c_str());
-            StrobeLightsOffCmd   = XPLMFindCommand(strobe_lights_switch_off.c_str());
-        }
-
-        // taxi lights switch disable - enable - remap
-        taxilightswitchenable = getOptionToInt("Taxi Lights Switch enable");
-        if (taxilightswitchenable == 0) {
-             XPSetWidgetProperty(SwitchDisableCheckWidget[18], xpProperty_ButtonState, 1);
-         }
-
-         if (taxilightswitchenable == 1) {
-             XPSetWidgetProperty(SwitchEnableCheckWidget[18], xpProperty_ButtonState, 1);
-         }
-
-         if (taxilightswitchenable == 2) {
-             XPSetWidgetProperty(SwitchRemapCheckWidget[18], xpProperty_ButtonState, 1);
-             taxi_lights_switch_on = getOptionToString("taxi_lights_switch_on_cmd");
-             taxi_lights_switch_off = getOptionToString("taxi_lights_switch_off_cmd");
-             TaxiLightsOnCmd   = XPLMFindCommand(taxi_lights_switch_on.c_str());
-             TaxiLightsOffCmd   = XPLMFindCommand(taxi_lights_switch_off.c_str());
-         }
-
-         // landing lights switch disable - enable - remap
-         landinglightswitchenable = getOptionToInt("Landing Lights Switch enable");
-         if (landinglightswitchenable == 0) {
-              XPSetWidgetProperty(SwitchDisableCheckWidget[19], xpProperty_ButtonState, 1);
-          }
-
-          if (landinglightswitchenable == 1) {
-              XPSetWidgetProperty(SwitchEnableCheckWidget[19], xpProperty_ButtonState, 1);
-              //XPSetWidgetProperty(SwitchRemapCheckWidget[19], xpProperty_ButtonState, 0);
-          }
-
-          if (landinglightswitchenable == 2) {
-              XPSetWidgetProperty(SwitchRemapCheckWidget[19], xpProperty_ButtonState, 1);
-              landing_lights_switch_on = getOptionToString("landing_lights_switch_on_cmd");
-              landing_lights_switch_off = getOptionToString("landing_lights_switch_off_cmd");
-              LandingLightsOnCmd   = XPLMFindCommand(landing_lights_switch_on.c_str());
-              LandingLightsOffCmd   = XPLMFindCommand(landing_lights_switch_off.c_str());
-          }
-
-    bataltinverse = getOptionToInt("Bat Alt inverse");
-
-    // landing lights switch disable - enable - remap
-    landinglightswitchenable = getOptionToInt("Landing Lights Switch enable");
-    if (landinglightswitchenable == 0) {
-         XPSetWidgetProperty(SwitchDisableCheckWidget[19], xpProperty_ButtonState, 1);
-     }
-
-
+    // switch panel mapping, every panel in one pass
+    process_read_switch_profiles();
 
     radspeed = getOptionToInt("Radio Freq Knob Pulse per Command");
     XPSetWidgetProperty(RadioSpeed1CheckWidget[0], xpProperty_ButtonState, 0);
@@ -658,24 +496,21 @@ void process_read_ini_file()
     navbuttonremap = getOptionToInt("Nav Button remapable");
     if (navbuttonremap == 1) {
          //XPSetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 1);
-         nav_button_remapable = getOptionToString("nav_button_remapable_cmd");
-         NavButtonRemapableCmd   = XPLMFindCommand(nav_button_remapable.c_str());
+         NavButtonRemapableCmd = bind_remap_command("nav_button_remapable_cmd", nav_button_remapable);
     }
 
     // apr button - remapable
     aprbuttonremap = getOptionToInt("Apr Button remapable");
     if (aprbuttonremap == 1) {
          //XPSetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 1);
-         apr_button_remapable = getOptionToString("apr_button_remapable_cmd");
-         AprButtonRemapableCmd   = XPLMFindCommand(apr_button_remapable.c_str());
+         AprButtonRemapableCmd = bind_remap_command("apr_button_remapable_cmd", apr_button_remapable);
     }
 
     // rev button - remapable
     revbuttonremap = getOptionToInt("Rev Button remapable");
     if (revbuttonremap == 1) {
          //XPSetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 1);
-         rev_button_remapable = getOptionToString("rev_button_remapable_cmd");
-         RevButtonRemapableCmd   = XPLMFindCommand(rev_button_remapable.c_str());
+         RevButtonRemapableCmd = bind_remap_command("rev_button_remapable_cmd", rev_button_remapable);
     }
 
     // ap vs up - remapable
@@ -683,8 +518,7 @@ void process_read_ini_file()
     if (apvsupremap == 1) {
          //XPSetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 1);
         // ApVsUp
-         ap_vs_up_remapable = getOptionToString("ap_vs_up_remapable_cmd");
-         ApVsUpRemapableCmd   = XPLMFindCommand(ap_vs_up_remapable.c_str());
+         ApVsUpRemapableCmd = bind_remap_command("ap_vs_up_remapable_cmd", ap_vs_up_remapable);
     }
 
     // ap vs dn - remapable
@@ -692,9 +526,10 @@ void process_read_ini_file()
     if (apvsdnremap == 1) {
          //XPSetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 1);
         // ApVsUp
-         ap_vs_dn_remapable = getOptionToString("ap_vs_dn_remapable_cmd");
-         ApVsDnRemapableCmd   = XPLMFindCommand(ap_vs_dn_remapable.c_str());
+         ApVsDnRemapableCmd = bind_remap_command("ap_vs_dn_remapable_cmd", ap_vs_dn_remapable);
     }
 
+    process_remap_summary();
+
   return;
 }
@@ -73,6 +73,7 @@ XPLMDataRef Nav2DmeNmDist = NULL, Nav2DmeSpeed = NULL;
 XPLMDataRef DmeFreq = NULL, DmeTime = NULL, DmeSpeed = NULL;
 
 XPLMDataRef AvPwrOn = NULL, BatPwrOn = NULL;
+int buspower = -1;
 
 
 XPLMDataRef Nav1PwrOn = NULL, Nav2PwrOn = NULL, Com1PwrOn = NULL, Com2PwrOn = NULL;
@@ -117,6 +118,7 @@ XPLMCommandRef FlapsDn = NULL, FlapsUp = NULL;
 XPLMCommandRef PitchTrimDn = NULL, PitchTrimUp = NULL, PitchTrimTkOff = NULL;
 
 XPLMCommandRef XpanelsFnButtonCommand = NULL, XpanelsCrsToggleCommand = NULL;
+XPLMCommandRef XpanelsUnboundRemapCommand = NULL;
 
 XPLMCommandRef x737mcp_cmd_a_toggle = NULL;
 XPLMCommandRef x737mcp_hdg_up = NULL, x737mcp_hdg_down = NULL;
@@ -192,32 +194,6 @@ XPLMCommandRef StLtOn = NULL, StLtOff = NULL, NvLtOn = NULL, NvLtOff = NULL;
 XPLMCommandRef BcLtOn = NULL, BcLtOff = NULL, GearUp = NULL, GearDn = NULL;
 
 
-XPLMCommandRef MagOffSwitchOnCmd = NULL, MagOffSwitchOffCmd = NULL;
-XPLMCommandRef MagRightSwitchOnCmd = NULL, MagRightSwitchOffCmd = NULL;
-XPLMCommandRef MagLeftSwitchOnCmd = NULL, MagLeftSwitchOffCmd = NULL;
-XPLMCommandRef MagBothSwitchOnCmd = NULL, MagBothSwitchOffCmd = NULL;
-XPLMCommandRef MagStartSwitchOnCmd = NULL, MagStartSwitchOffCmd = NULL;
-
-XPLMCommandRef BatMasterSwitchOnCmd = NULL, BatMasterSwitchOffCmd = NULL;
-XPLMCommandRef AltMasterSwitchOnCmd = NULL, AltMasterSwitchOffCmd = NULL;
-XPLMCommandRef AvMasterSwitchOnCmd = NULL, AvMasterSwitchOffCmd = NULL;
-
-
-
-XPLMCommandRef FuelPumpOnCmd = NULL, FuelPumpOffCmd = NULL;
-XPLMCommandRef DeiceOnCmd = NULL, DeiceOffCmd = NULL;
-XPLMCommandRef PitotHeatOnCmd = NULL, PitotHeatOffCmd = NULL;
-XPLMCommandRef GearUpCmd = NULL, GearDnCmd = NULL;
-
-XPLMCommandRef CowlFlapsOpenCmd = NULL, CowlFlapsCloseCmd = NULL;
-XPLMCommandRef PanelLightsOnCmd = NULL, PanelLightsOffCmd = NULL;
-XPLMCommandRef BeaconLightsOnCmd = NULL, BeaconLightsOffCmd = NULL;
-XPLMCommandRef NavLightsOnCmd = NULL, NavLightsOffCmd = NULL;
-XPLMCommandRef StrobeLightsOnCmd = NULL, StrobeLightsOffCmd = NULL;
-XPLMCommandRef TaxiLightsOnCmd = NULL, TaxiLightsOffCmd = NULL;
-XPLMCommandRef LandingLightsOnCmd = NULL, LandingLightsOffCmd = NULL;
-
-
 XPLMCommandRef MagOff1 = NULL, MagOff2 = NULL, MagOff3 = NULL, MagOff4 = NULL;
 XPLMCommandRef MagOff5 = NULL, MagOff6 = NULL, MagOff7 = NULL, MagOff8 = NULL;
 
@@ -257,7 +233,8 @@ XPLMCommandRef x737ice_wing_on = NULL, x737ice_wing_off = NULL;
 
 // ******************* Switch Panel Data Ref ********************
 XPLMDataRef BatNum = NULL, GenNum = NULL, EngNum = NULL;
-XPLMDataRef BatArrayOnDR = NULL;
+XPLMDataRef BatArrayOnDR = NULL, GenArrayOnDR = NULL;
+XPLMDataRef IgnitionKeyDR = NULL, FuelPumpArrayOnDR = NULL;
 
 XPLMDataRef CowlFlaps = NULL, CockpitLights = NULL, AntiIce = NULL;
 XPLMDataRef GearRetract = NULL, OnGround = NULL, LandingGearStatus = {NULL};
@@ -293,14 +270,10 @@ XPLMDataRef gTimeSimIsRunningXDataRef = NULL;
 
 XPLMMenuID      XsaitekpanelsMenu;
 XPLMMenuID      BipMenu;
-XPLMMenuID      BipMenuId, Bip2MenuId, Bip3MenuId, Bip4MenuId;
 XPLMMenuID      ConfigMenuId;
 
 XPWidgetID      XsaitekpanelsWidgetID = NULL;
 XPWidgetID      BipWidgetID = NULL;
-XPWidgetID      Bip2WidgetID = NULL;
-XPWidgetID      Bip3WidgetID = NULL;
-XPWidgetID      Bip4WidgetID = NULL;
 
 // ********************** Radio Panel variables ************************
 int radcnt = 0, radiores, stopradcnt;
@@ -338,6 +311,7 @@ static unsigned char blankmultiwbuf[13];
 unsigned char multibuf[4], multiwbuf[13];
 
 int loaded737 = 0;
+static int multiloadedac = 0;
 
 int trimspeed, multispeed, autothrottleswitchenable;
 
@@ -345,6 +319,8 @@ int navbuttonremap, aprbuttonremap, revbuttonremap;
 int apvsupremap, apvsdnremap;
 
 int xpanelsfnbutton = 0, xpanelscrstoggle = 0;
+int multiusbwrites = 0;
+XPLMDataRef MultiUsbWritesDataRef = NULL;
 
 void CreateMultiWidget(int x1, int y1, int w, int h);
 int MultiHandler(XPWidgetMessage  MultiinMessage, XPWidgetID  MultiWidgetID, intptr_t  inParam1, intptr_t  inParam2);
@@ -377,48 +353,16 @@ hid_device *multihandle;
 
 // ****************** Switch Panel variables *******************************
 int switchcnt = 0, switchres, stopswitchcnt;
-
-int magoffswitchenable, magrightswitchenable, magleftswitchenable;
-int magbothswitchenable, magstartswitchenable;
-int batmasterswitchenable, altmasterswitchenable;
-int avionicsmasterswitchenable, fuelpumpswitchenable;
-int deiceswitchenable, pitotheatswitchenable;
-int landinggearknobupenable, landinggearknobdnenable;
-int cowlflapsenable, panellightswitchenable;
-int beaconlightswitchenable, navlightswitchenable;
-int strobelightswitchenable, taxilightswitchenable;
-int landinglightswitchenable, bataltinverse;
-int panellightsenable;
-
-string mag_off_switch_on, mag_off_switch_off;
-string mag_right_switch_on, mag_right_switch_off;
-string mag_left_switch_on, mag_left_switch_off;
-string mag_both_switch_on, mag_both_switch_off;
-string mag_start_switch_on, mag_start_switch_off;
-
-string bat_master_switch_on, bat_master_switch_off;
-string alt_master_switch_on, alt_master_switch_off;
-string av_master_switch_on, av_master_switch_off;
-
-
-string fuel_pump_switch_on, fuel_pump_switch_off;
-string deice_switch_on, deice_switch_off;
-string pitot_heat_switch_on, pitot_heat_switch_off;
-string gear_switch_up, gear_switch_down;
-string cowl_flaps_open, cowl_flaps_close;
-string panel_lights_switch_on, panel_lights_switch_off;
-string beacon_lights_switch_on, beacon_lights_switch_off;
-string nav_lights_switch_on, nav_lights_switch_off;
-string strobe_lights_switch_on, strobe_lights_switch_off;
-string taxi_lights_switch_on, taxi_lights_switch_off;
-string landing_lights_switch_on, landing_lights_switch_off;
-
+int switchusbwrites = 0;
+XPLMDataRef SwitchUsbWritesDataRef = NULL;
+XPLMDataRef SwitchServiceTimeDataRef = NULL;
 
 const char *GearTestStrUp;
 
-static unsigned char blankswitchwbuf[2];
-unsigned char switchbuf[4], switchwbuf[2];
-float LandingGearDeployRatio[10];
+std::list<SwitchPanel *> switchpanels;
+SwitchProfileSet switchprofilesets[2];
+SwitchProfileSet *switchprofile = &switchprofilesets[0];
+int switchbindgen = 0;
 
 void SwitchMenuHandler(void *, void *);
 void CreateSwitchWidget(int x1, int y1, int w, int h);
@@ -453,18 +397,9 @@ char SwitchText[50][200] = {
 
 };
 
-hid_device *switchhandle;
-
 // ****************** BIP Panel variables *******************************
-int bipcnt = 0, biptmpcnt = 0, bipres, biploop[4], stopbipcnt;
+int bipcnt = 0;
 int bipnum = 0;
-int bipwcscmp0 = 0, bipwcscmp1 = 1;
-unsigned char bipwbuf[4][10];
-
-#define MAX_STR 255
-wchar_t wstr[4][MAX_STR];
-
-hid_device *biphandle[4];
 
 // ****************** Saitek Panels variables *******************************
 void XsaitekpanelsMenuHandler(void *, void *);
@@ -483,6 +418,7 @@ int wrgHostID = 0;
 
 void process_radio_panel();
 void process_multi_panel();
+void process_multi_select_aircraft(int aircraft);
 void process_switch_panel();
 void process_bip_panel();
 void process_pref_file();
@@ -494,6 +430,38 @@ void process_radio_panel() {
   }
 }
 
+// ***************** Bus Power *******************
+// Battery and avionics power are read here once per frame, and panels
+// only hear about it when one of them changes.
+void process_bus_power()
+{
+  int state = 0;
+
+  if (XPLMGetDatai(BatPwrOn) != 0) {
+    state |= BUS_POWER_BATTERY;
+  }
+  if (XPLMGetDatai(AvPwrOn) != 0) {
+    state |= BUS_POWER_AVIONICS;
+  }
+  if (state == buspower) {
+    return;
+  }
+  buspower = state;
+
+  for (std::list<Radio *>::iterator it = radios.begin(); it != radios.end(); it++) {
+    (*it)->power(state);
+  }
+  if (multicnt > 0) {
+    process_multi_power(state);
+  }
+  for (std::list<SwitchPanel *>::iterator it = switchpanels.begin(); it != switchpanels.end(); it++) {
+    (*it)->power(state);
+  }
+  if (bipcnt > 0) {
+    process_bip_power(state);
+  }
+}
+
 // ********************* MyPanelsFlightLoopCallback **************************
 float	MyPanelsFlightLoopCallback(
                                    float                inElapsedSinceLastCall,    
@@ -505,6 +473,9 @@ int    XpanelsFnButtonCommandHandler(XPLMCommandRef       inCommand,          //
                                XPLMCommandPhase     inPhase,
                                void *               inRefcon);
 
+int    UsbWritesGetCB(void * inRefcon);
+int    SwitchServiceTimeGetCB(void * inRefcon, float * outValues, int inOffset, int inMax);
+
 void WriteCSVTableToDisk(void);
 
 bool ReadConfigFile(std::string PlaneICAO);
@@ -515,7 +486,6 @@ PLUGIN_API int XPluginStart(char *		outName,
 {
 
   int ConfigSubMenuItem;
-  int BipSubMenuItem, Bip2SubMenuItem;
   int MultiSubMenuItem, RadioSubMenuItem;
   int SwitchSubMenuItem;
 
@@ -664,6 +634,8 @@ PLUGIN_API int XPluginStart(char *		outName,
   FlapsUp = XPLMFindCommand("sim/flight_controls/flaps_up");
 
   XpanelsFnButtonCommand = XPLMCreateCommand("xplugins/xsaitekpanels/x_panels_fn_button","Xpanels Fn Button");
+  // * no handler is registered, so remaps that fail to resolve land here and do nothing *
+  XpanelsUnboundRemapCommand = XPLMCreateCommand("xplugins/xsaitekpanels/unbound_remap","Xpanels Unbound Remap");
 
 
 // **************** Find Multi Panel Data Ref ********************
@@ -827,6 +799,9 @@ PLUGIN_API int XPluginStart(char *		outName,
   GenNum            = XPLMFindDataRef("sim/aircraft/electrical/num_generators");
   EngNum            = XPLMFindDataRef("sim/aircraft/engine/acf_num_engines");
   BatArrayOnDR      = XPLMFindDataRef("sim/cockpit/electrical/battery_array_on");
+  GenArrayOnDR      = XPLMFindDataRef("sim/cockpit/electrical/generator_on");
+  IgnitionKeyDR     = XPLMFindDataRef("sim/cockpit2/engine/actuators/ignition_key");
+  FuelPumpArrayOnDR = XPLMFindDataRef("sim/cockpit/engine/fuel_pump_on");
 
 
 
@@ -868,14 +843,18 @@ PLUGIN_API int XPluginStart(char *		outName,
 
   struct hid_device_info *switch_devs, *switch_cur_dev;
 
+  switch_profile_publish(switch_profile_defaults(switch_profile_spare()));
+
   switch_devs = hid_enumerate(0x6a3, 0x0d67);
   switch_cur_dev = switch_devs;
   while (switch_cur_dev) {
-        switchhandle = hid_open_path(switch_cur_dev->path);
-        hid_set_nonblocking(switchhandle, 1);
-        switchres = hid_read(switchhandle, switchbuf, sizeof(switchbuf));
-        hid_send_feature_report(switchhandle, switchwbuf, 2);
-        switchcnt++;
+        if (switchcnt < SWITCH_PANEL_MAX) {
+            hid_device *handle = hid_open_path(switch_cur_dev->path);
+            if (handle) {
+                switchpanels.push_back(new SwitchPanel(handle, switchcnt));
+                switchcnt++;
+            }
+        }
         switch_cur_dev = switch_cur_dev->next;
   }
   hid_free_enumeration(switch_devs);
@@ -883,69 +862,7 @@ PLUGIN_API int XPluginStart(char *		outName,
 
   // *** Find Connected BIP Panel *****
 
-  struct hid_device_info *bip_devs, *bip_cur_dev;
-
-  bip_devs = hid_enumerate(0x6a3, 0xb4e);
-  bip_cur_dev = bip_devs;
-  char	buf[256];
-  int result;
-  // find serial numbers of all BIP's connected
-  while (bip_cur_dev) {
-      biphandle[biptmpcnt] = hid_open_path(bip_cur_dev->path);
-      hid_get_serial_number_string(biphandle[biptmpcnt], wstr[biptmpcnt], MAX_STR);
-      //sprintf(buf, "biptmpcnt = %d  Serial Number String: %ls\n", biptmpcnt, wstr[biptmpcnt]);
-      //XPLMDebugString(buf);
-      hid_close(biphandle[biptmpcnt]);
-      biptmpcnt++;
-      bip_cur_dev = bip_cur_dev->next;
-  }
-
-  hid_free_enumeration(bip_devs);
-
-  if (biptmpcnt > 1) {
-
-     result = wcscmp(wstr[0], wstr[1]);
-     if(result > 0){
-       //sprintf(buf, "(result > 0) %ls > %ls\n", wstr[0], wstr[1]);
-       //XPLMDebugString(buf);
-       biphandle[0] = hid_open(0x6a3, 0xb4e, wstr[0]);
-       bipwbuf[0][0] = 0xb2; // 0xb2 Report ID for brightness
-       bipwbuf[0][1] = 100;  // Set brightness to 100%
-       bipres = hid_send_feature_report(biphandle[0], bipwbuf[0], 10);
-       bipwcscmp0 = 0;
-
-       biphandle[1] = hid_open(0x6a3, 0xb4e, wstr[1]);
-       bipwbuf[1][0] = 0xb2; // 0xb2 Report ID for brightness
-       bipwbuf[1][1] = 100;  // Set brightness to 100%
-       bipres = hid_send_feature_report(biphandle[1], bipwbuf[1], 10);
-       bipwcscmp1 = 1;
-
-     }else if (result < 0){
-       //sprintf(buf, "(result < 0) %ls < %ls\n", wstr[0], wstr[1]);
-       //XPLMDebugString(buf);
-       biphandle[1] = hid_open(0x6a3, 0xb4e, wstr[0]);
-       bipwbuf[0][0] = 0xb2; // 0xb2 Report ID for brightness
-       bipwbuf[0][1] = 100;  // Set brightness to 100%
-       bipres = hid_send_feature_report(biphandle[1], bipwbuf[0], 10);
-       bipwcscmp0 = 0;
-
-       biphandle[0] = hid_open(0x6a3, 0xb4e, wstr[1]);
-       bipwbuf[1][0] = 0xb2; // 0xb2 Report ID for brightness
-       bipwbuf[1][1] = 100;  // Set brightness to 100%
-       bipres = hid_send_feature_report(biphandle[0], bipwbuf[1], 10);
-       bipwcscmp1 = 1;
-
-     }
-
- }else if (biptmpcnt == 1){
-      biphandle[0] = hid_open(0x6a3, 0xb4e, wstr[0]);
-      bipwbuf[0][0] = 0xb2; // 0xb2 Report ID for brightness
-      bipwbuf[0][1] = 100;  // Set brightness to 100%
-      bipres = hid_send_feature_report(biphandle[0], bipwbuf[0], 10);
-      bipwcscmp0 = 0;
-  }
-
-  bipcnt = biptmpcnt;
+  bipcnt = bip_panels_open();
 
   // * Register our callback for every loop. Positive intervals
   // * are in seconds, negative are the negative of sim frames.  Zero
@@ -955,6 +872,43 @@ PLUGIN_API int XPluginStart(char *		outName,
                         interval,			// * Interval -1 every loop*
                         NULL);				// * refcon not used. *
 
+  // Register our custom datarefs
+  MultiUsbWritesDataRef = XPLMRegisterDataAccessor(
+                             "xplugins/xsaitekpanels/multipanel/usb_writes",
+                             xplmType_Int,                // in Type
+                             0,                           // Not writable
+                             UsbWritesGetCB, NULL,        // Integer accessors
+                             NULL, NULL,                  // Float accessors
+                             NULL, NULL,                  // Double accessors
+                             NULL, NULL,                  // Int array accessors
+                             NULL, NULL,                  // Float array accessors
+                             NULL, NULL,                  // Raw data accessors
+                             &multiusbwrites, NULL);      // Read refcon is the counter
+
+  SwitchUsbWritesDataRef = XPLMRegisterDataAccessor(
+                             "xplugins/xsaitekpanels/switchpanel/usb_writes",
+                             xplmType_Int,                // in Type
+                             0,                           // Not writable
+                             UsbWritesGetCB, NULL,        // Integer accessors
+                             NULL, NULL,                  // Float accessors
+                             NULL, NULL,                  // Double accessors
+                             NULL, NULL,                  // Int array accessors
+                             NULL, NULL,                  // Float array accessors
+                             NULL, NULL,                  // Raw data accessors
+                             &switchusbwrites, NULL);     // Read refcon is the counter
+
+  SwitchServiceTimeDataRef = XPLMRegisterDataAccessor(
+                             "xplugins/xsaitekpanels/switchpanel/service_us",
+                             xplmType_FloatArray,         // in Type
+                             0,                           // Not writable
+                             NULL, NULL,                  // Integer accessors
+                             NULL, NULL,                  // Float accessors
+                             NULL, NULL,                  // Double accessors
+                             NULL, NULL,                  // Int array accessors
+                             SwitchServiceTimeGetCB, NULL, // Float array accessors
+                             NULL, NULL,                  // Raw data accessors
+                             NULL, NULL);                 // Refcons not used
+
   // Register our custom commands
   XPLMRegisterCommandHandler(XpanelsFnButtonCommand,           // in Command name
                              XpanelsFnButtonCommandHandler,    // in Handler
@@ -996,21 +950,7 @@ PLUGIN_API int XPluginStart(char *		outName,
    if (bipcnt > 0) {
 
      if(bipcnt > 0){
-       BipSubMenuItem = XPLMAppendMenuItem(
-               XsaitekpanelsMenu,
-               "Bip",
-               NULL,
-               2);
-
-
-       BipMenuId = XPLMCreateMenu(
-               "Bip",
-               XsaitekpanelsMenu,
-               BipSubMenuItem,
-               XsaitekpanelsMenuHandler,
-               (void *)2);
-
-
+       bip_panels_menus(XsaitekpanelsMenu, XsaitekpanelsMenuHandler);
 
        BipWidgetID = XPCreateWidget(XPLMGetDatai(XPLMFindDataRef("sim/graphics/view/window_width"))-150,
                                     XPLMGetDatai(XPLMFindDataRef("sim/graphics/view/window_height")),
@@ -1023,21 +963,6 @@ PLUGIN_API int XPluginStart(char *		outName,
        XPSetWidgetProperty(BipWidgetID, xpProperty_CaptionLit, 0);
      }
 
-     if(bipcnt > 1) {
-       Bip2SubMenuItem = XPLMAppendMenuItem(
-           XsaitekpanelsMenu,
-           "Bip2",
-           NULL,
-           3);
-
-       Bip2MenuId = XPLMCreateMenu(
-           "Bip2",
-           XsaitekpanelsMenu,
-           Bip2SubMenuItem,
-           XsaitekpanelsMenuHandler,
-           (void *)3);
-     }
-
    }
 
    if (multicnt > 0) {
@@ -1188,72 +1113,26 @@ PLUGIN_API void	XPluginStop(void)
   }
 
 
-// *** if open close that switch panel ***
-
-  if (switchcnt > 0) {
+// *** blank and close every switch panel ***
 
-      blankswitchwbuf[0] = 0;
-      blankswitchwbuf[1] = 0;
-      switchres = hid_send_feature_report(switchhandle, blankswitchwbuf, 2);
-      hid_close(switchhandle);
+  for (std::list<SwitchPanel *>::iterator it = switchpanels.begin(); it != switchpanels.end(); it++) {
+      delete *it;
   }
+  switchpanels.clear();
+  switchcnt = 0;
 
 // *** if open close that bip panel ***
 
-  stopbipcnt = bipcnt - 1;
-
-
-  if (stopbipcnt == 3) {
-
-       bipwbuf[3][0] = 0xb8;  //0xb8 Report ID to display
-       bipwbuf[3][1] = 0, bipwbuf[3][2] = 0, bipwbuf[3][3] = 0;
-       bipwbuf[3][4] = 0, bipwbuf[3][5] = 0, bipwbuf[3][6] = 0;
-
-       bipres = hid_send_feature_report(biphandle[stopbipcnt], bipwbuf[stopbipcnt], 10);
-       hid_close(biphandle[stopbipcnt]);
-       stopbipcnt--;
-  }
-
-  if (stopbipcnt == 2) {
-
-       bipwbuf[2][0] = 0xb8;  //0xb8 Report ID to display
-       bipwbuf[2][1] = 0, bipwbuf[2][2] = 0, bipwbuf[2][3] = 0;
-       bipwbuf[2][4] = 0, bipwbuf[2][5] = 0, bipwbuf[2][6] = 0;
-
-       bipres = hid_send_feature_report(biphandle[stopbipcnt], bipwbuf[stopbipcnt], 10);
-       hid_close(biphandle[stopbipcnt]);
-       stopbipcnt--;
-  }
-
-  if (stopbipcnt == 1) {
-
-       bipwbuf[1][0] = 0xb8;  //0xb8 Report ID to display
-       bipwbuf[1][1] = 0, bipwbuf[1][2] = 0, bipwbuf[1][3] = 0;
-       bipwbuf[1][4] = 0, bipwbuf[1][5] = 0, bipwbuf[1][6] = 0;
-
-       bipres = hid_send_feature_report(biphandle[stopbipcnt], bipwbuf[stopbipcnt], 10);
-       hid_close(biphandle[stopbipcnt]);
-       stopbipcnt--;
-  }
-
-  if (stopbipcnt == 0) {
-
-       bipwbuf[0][0] = 0xb8;  //0xb8 Report ID to display
-       bipwbuf[0][1] = 0, bipwbuf[0][2] = 0, bipwbuf[0][3] = 0;
-       bipwbuf[0][4] = 0, bipwbuf[0][5] = 0, bipwbuf[0][6] = 0;
-
-       bipres = hid_send_feature_report(biphandle[stopbipcnt], bipwbuf[stopbipcnt], 10);
-       hid_close(biphandle[stopbipcnt]);
-       stopbipcnt--;
-  }
+  bip_panels_close();
+  bipcnt = 0;
 
   // ********** Unregitser the callback on quit. *************
   XPLMUnregisterFlightLoopCallback(MyPanelsFlightLoopCallback, NULL);
   XPLMUnregisterCommandHandler(XpanelsFnButtonCommand, XpanelsFnButtonCommandHandler, 1, NULL);
+  XPLMUnregisterDataAccessor(MultiUsbWritesDataRef);
+  XPLMUnregisterDataAccessor(SwitchUsbWritesDataRef);
+  XPLMUnregisterDataAccessor(SwitchServiceTimeDataRef);
   XPDestroyWidget(BipWidgetID, 1);
-  XPLMDestroyMenu(BipMenuId);
-  XPLMDestroyMenu(Bip2MenuId);
-  XPLMDestroyMenu(Bip3MenuId);
   XPLMDestroyMenu(MultiMenuId);
   XPLMDestroyMenu(RadioMenuId);
   XPLMDestroyMenu(SwitchMenuId);
@@ -1286,26 +1165,18 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID	inFromWho,
     PlaneICAO.insert(1,ICAOString);
 
     if ((inMessage == XPLM_MSG_PLANE_LOADED) & ((intptr_t) inParam == 0)) {
+      process_switch_aircraft();
       process_read_ini_file();
     }
 
     if(bipcnt > 0){
 
-        if ((inMessage == XPLM_MSG_PLANE_LOADED) & ((intptr_t) inParam == 0)) {
-          process_bip_panel();
-          ReadConfigFile(PlaneICAO);
-          if(bipcnt > 1){
-             process_bip_panel();
-             ReadConfigFile(PlaneICAO);
-          }
-        }
-        if (inMessage == XPLM_MSG_AIRPORT_LOADED) {
-          ReadConfigFile(PlaneICAO);
-          if(bipcnt > 1){
-             process_bip_panel();
-             ReadConfigFile(PlaneICAO);
+        // * every BIP reads its own config for the new aircraft *
+        if (((inMessage == XPLM_MSG_PLANE_LOADED) & ((intptr_t) inParam == 0)) || (inMessage == XPLM_MSG_AIRPORT_LOADED)) {
+          for (bipnum = 0; bipnum < bipcnt; bipnum++) {
+            ReadConfigFile(PlaneICAO);
           }
-
+          bipnum = 0;
         }
 
     }
@@ -1322,44 +1193,16 @@ void XsaitekpanelsMenuHandler(void * inMenuRef, void * inItemRef)
 
     }
 
-    if((intptr_t)inMenuRef == 2){
-        bipnum = 0;
-        if (strcmp((char *) inItemRef, "[DEFAULT]") == 0) {
-              ReadConfigFile((char *) inItemRef);
-        }
-         if (strcmp((char *) inItemRef, "<<CSV>>") == 0) {
-             WriteCSVTableToDisk();
-         }
-         if (strcmp((char *) inItemRef, "[BIP_TEST]") == 0) {
-               ReadConfigFile((char *) inItemRef);
-         }
-
-         else {
-               ReadConfigFile((char *) inItemRef);
-
-         }
-
-    }
-
-    if((intptr_t)inMenuRef == 3){
-        bipnum = 1;
-        if (strcmp((char *) inItemRef, "[DEFAULT]") == 0) {
-
-             ReadConfigFile((char *) inItemRef);
-        }
-
+    if(((intptr_t)inMenuRef >= BIP_MENU_REF) && ((intptr_t)inMenuRef < BIP_MENU_REF + bipcnt)){
+        bipnum = (int) ((intptr_t)inMenuRef - BIP_MENU_REF);
         if (strcmp((char *) inItemRef, "<<CSV>>") == 0) {
              WriteCSVTableToDisk();
         }
 
-        if (strcmp((char *) inItemRef, "[BIP_TEST]") == 0) {
-               ReadConfigFile((char *) inItemRef);
-        }
-
         else {
                ReadConfigFile((char *) inItemRef);
 
-         }
+        }
 
     }
 
@@ -1587,7 +1430,7 @@ int	SwitchHandler(XPWidgetMessage  SwitchinMessage, XPWidgetID  SwitchWidgetID,
 {
         (void) inParam2;
         int State;
-        int Index1;
+        int Index1, Index2;
         if (SwitchinMessage == xpMessage_CloseButtonPushed)
         {
                 if (switchMenuItem == 1)
@@ -1634,277 +1477,31 @@ int	SwitchHandler(XPWidgetMessage  SwitchinMessage, XPWidgetID  SwitchWidgetID,
 
             State = XPGetWidgetProperty(SwitchBatAltCheckWidget[0], xpProperty_ButtonState, 0);
             if (State){
-                bataltinverse = 0;
+                switch_profile_bat_alt(0);
             }
             State = XPGetWidgetProperty(SwitchAltBatCheckWidget[0], xpProperty_ButtonState, 0);
             if (State){
-                bataltinverse = 1;
+                switch_profile_bat_alt(1);
            }
 
-            State = XPGetWidgetProperty(SwitchDisableCheckWidget[0], xpProperty_ButtonState, 0);
-            if (State){
-                magoffswitchenable = 0;
-            }
-            State = XPGetWidgetProperty(SwitchEnableCheckWidget[0], xpProperty_ButtonState, 0);
-            if (State){
-                magoffswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[0], xpProperty_ButtonState, 0);
-           if (State){
-               magoffswitchenable = 2;
-           }
-
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[1], xpProperty_ButtonState, 0);
-           if (State){
-                magrightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[1], xpProperty_ButtonState, 0);
-           if (State){
-                magrightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[1], xpProperty_ButtonState, 0);
-           if (State){
-               magrightswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[2], xpProperty_ButtonState, 0);
-           if (State){
-               magleftswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[2], xpProperty_ButtonState, 0);
-           if (State){
-                magleftswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[2], xpProperty_ButtonState, 0);
-           if (State){
-               magleftswitchenable = 2;
-           }
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[3], xpProperty_ButtonState, 0);
-           if (State){
-                magbothswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[3], xpProperty_ButtonState, 0);
-           if (State){
-                magbothswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[3], xpProperty_ButtonState, 0);
-           if (State){
-               magbothswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[4], xpProperty_ButtonState, 0);
-           if (State){
-                magstartswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[4], xpProperty_ButtonState, 0);
-           if (State){
-                magstartswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[4], xpProperty_ButtonState, 0);
-           if (State){
-               magstartswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[5], xpProperty_ButtonState, 0);
-           if (State){
-                batmasterswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[5], xpProperty_ButtonState, 0);
-           if (State){
-                batmasterswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[5], xpProperty_ButtonState, 0);
-           if (State){
-               batmasterswitchenable = 2;
-           }
-
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[6], xpProperty_ButtonState, 0);
-           if (State){
-                altmasterswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[6], xpProperty_ButtonState, 0);
-           if (State){
-                altmasterswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[6], xpProperty_ButtonState, 0);
-           if (State){
-               altmasterswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[7], xpProperty_ButtonState, 0);
-           if (State){
-                avionicsmasterswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[7], xpProperty_ButtonState, 0);
-           if (State){
-                avionicsmasterswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[7], xpProperty_ButtonState, 0);
-           if (State){
-               avionicsmasterswitchenable = 2;
-           }
-
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[8], xpProperty_ButtonState, 0);
-           if (State){
-                fuelpumpswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[8], xpProperty_ButtonState, 0);
-           if (State){
-                fuelpumpswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[8], xpProperty_ButtonState, 0);
-           if (State){
-               fuelpumpswitchenable = 2;
-           }
-
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[9], xpProperty_ButtonState, 0);
-           if (State){
-               deiceswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[9], xpProperty_ButtonState, 0);
-           if (State){
-               deiceswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[9], xpProperty_ButtonState, 0);
-           if (State){
-              deiceswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[10], xpProperty_ButtonState, 0);
-           if (State){
-              pitotheatswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[10], xpProperty_ButtonState, 0);
-           if (State){
-              pitotheatswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[10], xpProperty_ButtonState, 0);
-           if (State){
-             pitotheatswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[11], xpProperty_ButtonState, 0);
-           if (State){
-             landinggearknobupenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[11], xpProperty_ButtonState, 0);
-           if (State){
-             landinggearknobupenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[11], xpProperty_ButtonState, 0);
-           if (State){
-            landinggearknobupenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[12], xpProperty_ButtonState, 0);
-           if (State){
-            landinggearknobdnenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[12], xpProperty_ButtonState, 0);
-           if (State){
-            landinggearknobdnenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[12], xpProperty_ButtonState, 0);
-           if (State){
-           landinggearknobdnenable = 2;
-           }
-
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[13], xpProperty_ButtonState, 0);
-           if (State){
-             cowlflapsenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[13], xpProperty_ButtonState, 0);
-           if (State){
-             cowlflapsenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[13], xpProperty_ButtonState, 0);
-           if (State){
-            cowlflapsenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[14], xpProperty_ButtonState, 0);
-           if (State){
-            panellightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[14], xpProperty_ButtonState, 0);
-           if (State){
-            panellightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[14], xpProperty_ButtonState, 0);
-           if (State){
-             panellightswitchenable = 2;
-           }
-
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[15], xpProperty_ButtonState, 0);
-           if (State){
-             beaconlightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[15], xpProperty_ButtonState, 0);
-           if (State){
-              beaconlightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[15], xpProperty_ButtonState, 0);
-           if (State){
-             beaconlightswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[16], xpProperty_ButtonState, 0);
-           if (State){
-               navlightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[16], xpProperty_ButtonState, 0);
-           if (State){
-              navlightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[16], xpProperty_ButtonState, 0);
-           if (State){
-               navlightswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[17], xpProperty_ButtonState, 0);
-           if (State){
-               strobelightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[17], xpProperty_ButtonState, 0);
-           if (State){
-              strobelightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[17], xpProperty_ButtonState, 0);
-           if (State){
-               strobelightswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[18], xpProperty_ButtonState, 0);
-           if (State){
-               taxilightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[18], xpProperty_ButtonState, 0);
-           if (State){
-                taxilightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[18], xpProperty_ButtonState, 0);
-           if (State){
-               taxilightswitchenable = 2;
-           }
-
-           State = XPGetWidgetProperty(SwitchDisableCheckWidget[19], xpProperty_ButtonState, 0);
-           if (State){
-               landinglightswitchenable = 0;
-           }
-           State = XPGetWidgetProperty(SwitchEnableCheckWidget[19], xpProperty_ButtonState, 0);
-           if (State){
-               landinglightswitchenable = 1;
-           }
-           State = XPGetWidgetProperty(SwitchRemapCheckWidget[19], xpProperty_ButtonState, 0);
-           if (State){
-               landinglightswitchenable = 2;
+           // * the widget edits the live profile, the panels rebind on their next frame *
+           for (Index1 = 0; Index1 < SWITCH_ITEM_COUNT; Index1++)
+           {
+               Index2 = SWITCH_ITEM_WIDGET(Index1);
+               State = XPGetWidgetProperty(SwitchDisableCheckWidget[Index2], xpProperty_ButtonState, 0);
+               if (State){
+                   switch_profile_enable(Index1, 0);
+               }
+               State = XPGetWidgetProperty(SwitchEnableCheckWidget[Index2], xpProperty_ButtonState, 0);
+               if (State){
+                   switch_profile_enable(Index1, 1);
+               }
+               State = XPGetWidgetProperty(SwitchRemapCheckWidget[Index2], xpProperty_ButtonState, 0);
+               if (State){
+                   switch_profile_enable(Index1, 2);
+               }
            }
+           switchbindgen++;
 
         return 1;
 
@@ -2588,7 +2185,32 @@ int	MultiHandler(XPWidgetMessage  MultiinMessage, XPWidgetID  MultiWidgetID, int
   return 0 ;
 }
 
+// ******************* Panel USB Writes Datarefs *******************
+// * inRefcon points at the panel's write counter *
+int    UsbWritesGetCB(void * inRefcon)
+{
+    return *(int *) inRefcon;
+}
+
+// ******************* Switch Panel Service Time Dataref *******************
+// * average microseconds per frame spent on each switch panel, in device order *
+int    SwitchServiceTimeGetCB(void * inRefcon, float * outValues, int inOffset, int inMax)
+{
+    int n = 0, i = 0;
+
+    (void) inRefcon;
 
+    if (outValues == NULL) {
+        return switchcnt;
+    }
+    for (std::list<SwitchPanel *>::iterator it = switchpanels.begin(); it != switchpanels.end(); it++, i++) {
+        if ((i < inOffset) || (n >= inMax)) {
+            continue;
+        }
+        outValues[n++] = ((*it)->frames > 0) ? (float) ((*it)->servicetime / (*it)->frames) : 0.0f;
+    }
+    return n;
+}
 
 int    XpanelsFnButtonCommandHandler(XPLMCommandRef       inCommand,
                         XPLMCommandPhase     inPhase,
@@ -2622,6 +2244,8 @@ float	MyPanelsFlightLoopCallback(
     (void) inCounter; // To get rid of warnings on unused variables
     (void) inRefcon; // To get rid of warnings on unused variables
 
+  process_bus_power();
+
   //if(radcnt > 0){
     process_radio_panel();
   //}
@@ -2719,6 +2343,12 @@ float	MyPanelsFlightLoopCallback(
 
   }
 
+  // ***** Install the multi panel autopilot adapter when the aircraft changes *****
+  if (loaded737 != multiloadedac) {
+       multiloadedac = loaded737;
+       process_multi_select_aircraft(loaded737);
+  }
+
 
   return interval;
 }
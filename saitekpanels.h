@@ -7,8 +7,11 @@
 #include "XPStandardWidgets.h"
 
 #include "hidapi.h"
+#include "panelreport.h"
 
 #include <string>
+#include <list>
+#include <vector>
 
 using namespace std;
 
@@ -49,6 +52,21 @@ extern XPLMDataRef DmeFreq, DmeTime, DmeSpeed;
 
 extern XPLMDataRef AvPwrOn, BatPwrOn;
 
+// ***************** Bus Power ********************
+// Sampled once per frame by process_bus_power(). Each change is handed to
+// every panel, so they blank or restore once per transition.
+#define BUS_POWER_BATTERY   0x01
+#define BUS_POWER_AVIONICS  0x02
+#define BUS_POWER_DISPLAYS  (BUS_POWER_BATTERY | BUS_POWER_AVIONICS)
+
+extern int buspower;
+
+void process_multi_power(int state);
+void process_bip_power(int state);
+
+// * microsecond wall clock for service and load timing *
+double panel_clock_us();
+
 extern XPLMDataRef Nav1PwrOn, Nav2PwrOn, Com1PwrOn, Com2PwrOn;
 extern XPLMDataRef Afd1PwrOn, DmePwrOn;
 
@@ -117,6 +135,7 @@ extern XPLMCommandRef x737mcp_spd_changeover, x737mcp_lnav_toggle;
 extern XPLMCommandRef NavButtonRemapableCmd, AprButtonRemapableCmd;
 extern XPLMCommandRef RevButtonRemapableCmd;
 extern XPLMCommandRef ApVsUpRemapableCmd, ApVsDnRemapableCmd;
+extern XPLMCommandRef XpanelsUnboundRemapCommand;
 
 // ************ Multi Panel Data Ref *****************
 extern XPLMDataRef ApAlt, ApVs, ApAs, ApHdg, ApCrs, ApCrs2;
@@ -162,6 +181,7 @@ extern int navbuttonremap, aprbuttonremap, revbuttonremap;
 extern int apvsupremap, apvsdnremap;
 
 extern int xpanelsfnbutton;
+extern int multiusbwrites;
 extern int xpanelscrstoggle;
 extern int multi_auto_mul;
 
@@ -185,30 +205,6 @@ extern XPLMCommandRef LnLtOn, LnLtOff, TxLtOn, TxLtOff;
 extern XPLMCommandRef StLtOn, StLtOff, NvLtOn, NvLtOff;
 extern XPLMCommandRef BcLtOn, BcLtOff, GearUp, GearDn;
 
-extern XPLMCommandRef MagOffSwitchOnCmd, MagOffSwitchOffCmd;
-extern XPLMCommandRef MagRightSwitchOnCmd, MagRightSwitchOffCmd;
-extern XPLMCommandRef MagLeftSwitchOnCmd, MagLeftSwitchOffCmd;
-extern XPLMCommandRef MagBothSwitchOnCmd, MagBothSwitchOffCmd;
-extern XPLMCommandRef MagStartSwitchOnCmd, MagStartSwitchOffCmd;
-
-extern XPLMCommandRef BatMasterSwitchOnCmd, BatMasterSwitchOffCmd;
-extern XPLMCommandRef AltMasterSwitchOnCmd, AltMasterSwitchOffCmd;
-extern XPLMCommandRef AvMasterSwitchOnCmd, AvMasterSwitchOffCmd;
-
-
-extern XPLMCommandRef FuelPumpOnCmd, FuelPumpOffCmd;
-extern XPLMCommandRef DeiceOnCmd, DeiceOffCmd;
-extern XPLMCommandRef PitotHeatOnCmd, PitotHeatOffCmd;
-extern XPLMCommandRef GearUpCmd, GearDnCmd;
-
-extern XPLMCommandRef CowlFlapsOpenCmd, CowlFlapsCloseCmd;
-extern XPLMCommandRef PanelLightsOnCmd, PanelLightsOffCmd;
-extern XPLMCommandRef BeaconLightsOnCmd, BeaconLightsOffCmd;
-extern XPLMCommandRef NavLightsOnCmd, NavLightsOffCmd;
-extern XPLMCommandRef StrobeLightsOnCmd, StrobeLightsOffCmd;
-extern XPLMCommandRef TaxiLightsOnCmd, TaxiLightsOffCmd;
-extern XPLMCommandRef LandingLightsOnCmd, LandingLightsOffCmd;
-
 extern XPLMCommandRef MagOff1, MagOff2, MagOff3, MagOff4;
 extern XPLMCommandRef MagOff5, MagOff6, MagOff7, MagOff8;
 
@@ -250,7 +246,8 @@ extern XPLMCommandRef x737ice_wing_on, x737ice_wing_off;
 
 // ************** Switch Panel Data Ref ******************
 extern XPLMDataRef BatNum, GenNum, EngNum;
-extern XPLMDataRef BatArrayOnDR;
+extern XPLMDataRef BatArrayOnDR, GenArrayOnDR;
+extern XPLMDataRef IgnitionKeyDR, FuelPumpArrayOnDR;
 
 extern XPLMDataRef CowlFlaps, CockpitLights, AntiIce;
 extern XPLMDataRef GearRetract, OnGround, LandingGearStatus;
@@ -268,61 +265,158 @@ extern XPWidgetID      SwitchAltBatCheckWidget[50];
 // ***************** Switch Panel variables ********************
 extern int switchfd;
 
-extern int magoffswitchenable, magrightswitchenable, magleftswitchenable;
-extern int magbothswitchenable, magstartswitchenable;
-extern int batmasterswitchenable, altmasterswitchenable;
-extern int avionicsmasterswitchenable, fuelpumpswitchenable;
-extern int deiceswitchenable, pitotheatswitchenable;
-extern int landinggearknobupenable, landinggearknobdnenable;
-extern int cowlflapsenable, panellightswitchenable;
-extern int beaconlightswitchenable, navlightswitchenable;
-extern int strobelightswitchenable, taxilightswitchenable;
-extern int landinglightswitchenable, bataltinverse;
+extern int switchusbwrites;
+
+// ***************** Switch Panel Devices ********************
+// Each connected switch panel is one SwitchPanel with its own report
+// buffers, gear LED state and mapping profile. The first panel found uses
+// the normal ini keys and the switch widget, the others read the same keys
+// with a "Switch2 " or "switch2_" style prefix and fall back to the first
+// panel's mapping for anything they leave out.
+#define SWITCH_PANEL_MAX 4
+
+enum SwitchItem {
+  SWITCH_ITEM_MAG_OFF = 0,
+  SWITCH_ITEM_MAG_RIGHT,
+  SWITCH_ITEM_MAG_LEFT,
+  SWITCH_ITEM_MAG_BOTH,
+  SWITCH_ITEM_ENG_START,
+  SWITCH_ITEM_MASTER_BATTERY,
+  SWITCH_ITEM_MASTER_ALTENATOR,
+  SWITCH_ITEM_AVIONICS_POWER,
+  SWITCH_ITEM_FUEL_PUMP,
+  SWITCH_ITEM_DE_ICE,
+  SWITCH_ITEM_PITOT_HEAT,
+  SWITCH_ITEM_GEAR,
+  SWITCH_ITEM_COWL_FLAPS,
+  SWITCH_ITEM_PANEL_LIGHTS,
+  SWITCH_ITEM_BEACON_LIGHTS,
+  SWITCH_ITEM_NAV_LIGHTS,
+  SWITCH_ITEM_STROBE_LIGHTS,
+  SWITCH_ITEM_TAXI_LIGHTS,
+  SWITCH_ITEM_LANDING_LIGHTS,
+  SWITCH_ITEM_COUNT
+};
+
+// * the switch widget shows the gear knob twice, the down row maps to nothing *
+#define SWITCH_WIDGET_GEAR_DN 12
+#define SWITCH_ITEM_WIDGET(item) ((item) <= SWITCH_ITEM_GEAR ? (item) : (item) + 1)
+
+// * one panel's resolved mapping, enable is 0 off, 1 built in, 2 remapped *
+struct SwitchProfile {
+  int enable[SWITCH_ITEM_COUNT];
+  XPLMCommandRef oncmd[SWITCH_ITEM_COUNT];
+  XPLMCommandRef offcmd[SWITCH_ITEM_COUNT];
+  int bataltinverse;
+  unsigned int inherited;             // items copied from the first panel, bit SWITCH_ITEM_COUNT is bataltinverse
+};
+
+// * every panel's mapping for one aircraft, built whole and then swapped in *
+struct SwitchProfileSet {
+  SwitchProfile panel[SWITCH_PANEL_MAX];
+};
+
+extern SwitchProfileSet switchprofilesets[2];
+extern SwitchProfileSet *switchprofile;
+extern int switchbindgen;
 
+SwitchProfileSet *switch_profile_spare();
+SwitchProfileSet *switch_profile_defaults(SwitchProfileSet *set);
+void switch_profile_publish(SwitchProfileSet *set);
+void switch_profile_enable(int item, int enable);
+void switch_profile_bat_alt(int inverse);
 
+void process_switch_aircraft();
 
-//extern int bataltinverse, cowlflapsenable, fuelpumpswitchenable;
-//extern int deiceswitchenable, panellightsenable, landinggearknobenable;
+// ***************** Switch Bindings ********************
+// What each switch does is built into a table of bindings from the ini
+// mapping, and only the bindings on report bits that changed are run.
+#define SWITCH_REPORT_BITS PANEL_REPORT_BITS
 
-extern string mag_off_switch_on, mag_off_switch_off;
-extern string mag_right_switch_on, mag_right_switch_off;
-extern string mag_left_switch_on, mag_left_switch_off;
-extern string mag_both_switch_on, mag_both_switch_off;
-extern string mag_start_switch_on, mag_start_switch_off;
+enum SwitchEdge {
+  SWITCH_EDGE_ON = 0,                 // bit went to 1
+  SWITCH_EDGE_OFF                     // bit went to 0
+};
+
+enum SwitchAction {
+  SWITCH_ACT_COMMAND = 0,             // XPLMCommandOnce(cmd)
+  SWITCH_ACT_HOLD,                    // XPLMCommandBegin(cmd) on, XPLMCommandEnd(cmd) off
+  SWITCH_ACT_INT,                     // ref = value
+  SWITCH_ACT_FLOAT,                   // ref = value
+  SWITCH_ACT_INT_FILL,                // first *count elements of ref = value
+  SWITCH_ACT_FLOAT_FILL,              // first *count elements of ref = value
+  SWITCH_ACT_BUS_INT                  // ref = 1 if buspower has any of the value bits, again on power()
+};
+
+struct SwitchBinding {
+  unsigned char bit;
+  unsigned char edge;
+  unsigned char kind;
+  XPLMCommandRef cmd;
+  XPLMDataRef ref;
+  const int *gate;                    // only run while *gate >= gatemin
+  int gatemin;
+  int *count;
+  float value;
+};
 
-extern string bat_master_switch_on, bat_master_switch_off;
-extern string alt_master_switch_on, alt_master_switch_off;
-extern string av_master_switch_on, av_master_switch_off;
+class SwitchPanel {
+public:
+  hid_device *handle;
+  const SwitchProfile *profile;       // set by bind() from the live profile set
+  int index;
 
-extern string fuel_pump_switch_on, fuel_pump_switch_off;
-extern string deice_switch_on, deice_switch_off;
-extern string pitot_heat_switch_on, pitot_heat_switch_off;
-extern string gear_switch_up, gear_switch_down;
+  unsigned char read_buffer[4];
+  unsigned char write_buffer[2];
 
-extern string cowl_flaps_open, cowl_flaps_close;
-extern string panel_lights_switch_on, panel_lights_switch_off;
-extern string beacon_lights_switch_on, beacon_lights_switch_off;
-extern string nav_lights_switch_on, nav_lights_switch_off;
-extern string strobe_lights_switch_on, strobe_lights_switch_off;
-extern string taxi_lights_switch_on, taxi_lights_switch_off;
-extern string landing_lights_switch_on, landing_lights_switch_off;
+  unsigned char gearled, lastgearled;
+  int gearfailup[3], gearfaildn[3];
+  int gearstatekey;
+  float lastwrite;
 
+  // * binding table, ordered by report bit with bitstart[] as the index *
+  std::vector<SwitchBinding> bindings;
+  int bitstart[SWITCH_REPORT_BITS + 1];
+  panel_word lastword, resyncmask;       // lastword is the latest report
+  std::vector<XPLMCommandRef> activecmds;    // begun and not yet ended
+  int bindgen, bind737;
 
+  // * per device cost, reported when the panel is closed *
+  int reports, usbwrites, frames;
+  double servicetime, servicepeak;
 
-extern float LandingGearDeployRatio[10];
-extern hid_device *switchhandle;
+  void update();
+  void send();
+  void bind();
+  void dispatch(panel_word word);
+  void release();
+  void power(int state);
+
+  int powered;
+
+  SwitchPanel(hid_device *dev, int idx);
+  ~SwitchPanel();
+};
+
+extern std::list<SwitchPanel *> switchpanels;
 
 // ************** Bip Panel Data Ref ******************
 extern XPLMDataRef gTimeSimIsRunningXDataRef;
 
 extern XPLMMenuID      BipMenu;
-extern XPLMMenuID      BipMenuId, Bip2MenuId, Bip3MenuId, Bip4MenuId;
-extern XPWidgetID      BipWidgetID, Bip2WidgetID, Bip3WidgetID, Bip4WidgetID;
+extern XPWidgetID      BipWidgetID;
 
 // ***************** Bip Panel variables ********************
-extern hid_device *biphandle[4];
-extern int bipcnt, biptmpcnt, bipnum;
-extern int bipwcscmp0, bipwcscmp1;
+extern int bipcnt, bipnum;
+
+// ***************** Bip Panel Devices ********************
+// Every BIP is opened once, in serial number order, and kept in a registry
+// in bippanel.cpp. BIP n's menu reports BIP_MENU_REF + n to the handler.
+#define BIP_MENU_REF 100
+
+int bip_panels_open();
+void bip_panels_menus(XPLMMenuID parent, XPLMMenuHandler_f handler);
+void bip_panels_close();
 
 void WriteCSVTableToDisk(void);
 bool ReadConfigFile(std::string PlaneICAO);
@@ -344,7 +438,10 @@ public:
   uint8_t read_buffer[4];
   uint8_t write_buffer[24];
 
+  int powered;
+
   void update();
+  void power(int state);
   void writeToRadio();
   void setUpper(Panel *);
   void setLower(Panel *);
@@ -4,6 +4,7 @@
 
 #include "XPLMUtilities.h"
 #include "XPLMDataAccess.h"
+#include "XPLMProcessing.h"
 
 #include "saitekpanels.h"
 
@@ -15,1246 +16,799 @@
 #include <fcntl.h>
 #include <string.h>
 
-#define testbit(x, y)  ( ( ((const char*)&(x))[(y)>>3] & 0x80 >> ((y)&0x07)) >> (7-((y)&0x07) ) )
+#include <algorithm>
+
+#if IBM
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
 
 // ****************** Switch Panel variables *******************************
-static int switchnowrite = 0;
+static float switchkeepalive = 5.0;
 static int switchres, switchwres;
 
-static int batnum = 0, gennum = 0, engnum = 0;
-
-static float opencowl[8], closecowl[8];
+// ***************** Aircraft Constants *******************
+// Read once when an aircraft is loaded, never from the report loop.
+static int batnum = 0, gennum = 0, engnum = 0, gearretract = 0;
+static int switchaircraftread = 0;
 
-static int MAG_OFF = 10, MAG_RIGHT = 9, MAG_LEFT = 8, MAG_BOTH = 23;
-static int ENG_START = 22;
-static int MASTER_BATTERY = 7, MASTER_ALTENATOR = 6;
-static int AVIONICS_POWER = 5, FUEL_PUMP = 4;
-static int DE_ICE = 3, PITOT_HEAT = 2;
-static int COWL_FLAPS = 1, PANEL_LIGHTS = 0;
-static int BEACON_LIGHTS = 15, NAV_LIGHTS = 14;
-static int STROBE_LIGHTS = 13, TAXI_LIGHTS = 12;
-static int LANDING_LIGHTS = 11;
-static int GEAR_SWITCH_UP = 21, GEAR_SWITCH_DN = 20; 
-static int BatArrayOn[8];
-static int failed1up = 0, failed2up = 0, failed3up = 0;
-static int failed1dn = 0, failed2dn = 0, failed3dn = 0;
+// ***************** Frame Snapshot *******************
+// Gear values read once per frame and shared by every switch panel.
+static int snaponground = 0;
+static float snapgearratio[3];
+static int snapgearfail[3];
 
-static unsigned char switchbuf[4];
-static unsigned char switchwbuf[2], gearled;
 
-
-void process_switch_menu()
+// * report bit names, see panelreport.h for the numbering *
+static const int MAG_OFF = 10, MAG_RIGHT = 9, MAG_LEFT = 8, MAG_BOTH = 23;
+static const int ENG_START = 22;
+static int MASTER_BATTERY = 7, MASTER_ALTENATOR = 6;
+static const int AVIONICS_POWER = 5, FUEL_PUMP = 4;
+static const int DE_ICE = 3, PITOT_HEAT = 2;
+static const int COWL_FLAPS = 1, PANEL_LIGHTS = 0;
+static const int BEACON_LIGHTS = 15, NAV_LIGHTS = 14;
+static const int STROBE_LIGHTS = 13, TAXI_LIGHTS = 12;
+static const int LANDING_LIGHTS = 11;
+static const int GEAR_SWITCH_UP = 21, GEAR_SWITCH_DN = 20;
+
+// * the panel being serviced, the handlers below all work on this one *
+static SwitchPanel *sw = NULL;
+
+// ***************** Switch Mapping Profile *******************
+// The ini reader builds a whole SwitchProfileSet in the spare slot and then
+// publishes it with one pointer store. Everything runs on the sim's main
+// thread, so a panel either binds from the old set or the new one, never a
+// mix, and the old set becomes the spare for the next aircraft.
+SwitchProfileSet *switch_profile_spare()
 {
+    return (switchprofile == &switchprofilesets[0]) ? &switchprofilesets[1] : &switchprofilesets[0];
+}
 
-    XPLMClearAllMenuItems(SwitchMenuId);
-
-    XPLMAppendMenuItem(SwitchMenuId, "Switch Panel Widget", (void *) "SWITCH_WIDGET", 4);
-
+// * every switch built in, with nothing remapped yet *
+SwitchProfileSet *switch_profile_defaults(SwitchProfileSet *set)
+{
+    int panel, item;
 
-  switchwbuf[0] = 0;
-  switchwbuf[1] = gearled;
-  if (bataltinverse == 0) {
-    MASTER_BATTERY = 7, MASTER_ALTENATOR = 6;
-  }
-  if (bataltinverse == 1) {
-    MASTER_BATTERY = 6, MASTER_ALTENATOR = 7;
-  }
+    for (panel = 0; panel < SWITCH_PANEL_MAX; panel++) {
+        SwitchProfile *profile = &set->panel[panel];
 
+        for (item = 0; item < SWITCH_ITEM_COUNT; item++) {
+            profile->enable[item] = 1;
+            profile->oncmd[item] = XpanelsUnboundRemapCommand;
+            profile->offcmd[item] = XpanelsUnboundRemapCommand;
+        }
+        profile->bataltinverse = 0;
+        profile->inherited = (panel == 0) ? 0 : ~0u;
+    }
+    return set;
 }
 
-// ***************** Engines Mag Off ********************
+void switch_profile_publish(SwitchProfileSet *set)
+{
+    switchprofile = set;
+    switchbindgen++;
+}
 
-void process_engines_mag_off_switch()
+// * widget edits go to the first panel and every panel that follows it *
+void switch_profile_enable(int item, int enable)
 {
+    int panel;
 
-    if(magoffswitchenable == 0) {
-        return;
+    for (panel = 0; panel < SWITCH_PANEL_MAX; panel++) {
+        SwitchProfile *profile = &switchprofile->panel[panel];
+
+        if ((panel == 0) || (profile->inherited & (1u << item))) {
+            profile->enable[item] = enable;
+        }
     }
+}
 
-   if(magoffswitchenable == 2) {
+void switch_profile_bat_alt(int inverse)
+{
+    int panel;
 
-        if(testbit(switchbuf,MAG_OFF)) {
-          XPLMCommandOnce(MagOffSwitchOnCmd);
-         }
+    for (panel = 0; panel < SWITCH_PANEL_MAX; panel++) {
+        SwitchProfile *profile = &switchprofile->panel[panel];
 
-        if(!testbit(switchbuf,MAG_OFF)) {
-          XPLMCommandOnce(MagOffSwitchOffCmd);
+        if ((panel == 0) || (profile->inherited & (1u << SWITCH_ITEM_COUNT))) {
+            profile->bataltinverse = inverse;
         }
-
-        return;
     }
-	if(testbit(switchbuf,MAG_OFF)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(MagOff1);
-	  }   
-	  if(engnum == 2){
-	    XPLMCommandOnce(MagOff1);
-	    XPLMCommandOnce(MagOff2);
-	  } 
-	  if(engnum == 3){
-	    XPLMCommandOnce(MagOff1);
-	    XPLMCommandOnce(MagOff2);
-	    XPLMCommandOnce(MagOff3);
-	  }
-	  if(engnum == 4){
-	    XPLMCommandOnce(MagOff1);
-	    XPLMCommandOnce(MagOff2);
-	    XPLMCommandOnce(MagOff3);
-	    XPLMCommandOnce(MagOff4);
-	  }
- 	}
-
 }
 
-// ***************** Engines Right Mag *******************
-
-void process_engines_right_mag_switch()
+// ***************** Panel Service Clock *******************
+double panel_clock_us()
 {
+#if IBM
+    LARGE_INTEGER count, freq;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double) count.QuadPart * 1000000.0 / (double) freq.QuadPart;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double) tv.tv_sec * 1000000.0 + (double) tv.tv_usec;
+#endif
+}
 
-    if(magrightswitchenable == 0) {
-        return;
-    }
-
-   if(magrightswitchenable == 2) {
 
-        if(testbit(switchbuf,MAG_RIGHT)) {
-          XPLMCommandOnce(MagRightSwitchOnCmd);
-         }
+// ***************** Engine Vector *******************
+// Per engine, battery and generator array datarefs are filled with one
+// value for the first count elements and written with a single call, and
+// only when the sim does not already hold that value. Four engines cost the
+// same as one.
+#define ENGINE_VECTOR_MAX 8
 
-        if(!testbit(switchbuf,MAG_RIGHT)) {
-          XPLMCommandOnce(MagRightSwitchOffCmd);
-        }
+// ***** Magneto positions in sim/cockpit2/engine/actuators/ignition_key *****
+#define IGNITION_OFF   0
+#define IGNITION_LEFT  1
+#define IGNITION_RIGHT 2
+#define IGNITION_BOTH  3
 
-        return;
-    }
-	if(testbit(switchbuf,MAG_RIGHT)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(MagRight1);
-	  }   
-	  if(engnum == 2){
-	    XPLMCommandOnce(MagRight1);
-	    XPLMCommandOnce(MagRight2);
-	  }
-	  if(engnum == 3){
-	    XPLMCommandOnce(MagRight1);
-	    XPLMCommandOnce(MagRight2);
-	    XPLMCommandOnce(MagRight3);
-	  }
-	  if(engnum == 4){
-	    XPLMCommandOnce(MagRight1);
-	    XPLMCommandOnce(MagRight2);
-	    XPLMCommandOnce(MagRight3);
-	    XPLMCommandOnce(MagRight4);
-	  }
- 	}
+static int engine_vector_get(XPLMDataRef ref, int *values, int count)
+{
+    return XPLMGetDatavi(ref, values, 0, count);
 }
 
-// ***************** Engines Left Mag *******************
-
-void process_engines_left_mag_switch()
+static int engine_vector_get(XPLMDataRef ref, float *values, int count)
 {
+    return XPLMGetDatavf(ref, values, 0, count);
+}
 
-    if(magleftswitchenable == 0) {
-        return;
-    }
-
-   if(magleftswitchenable == 2) {
+static void engine_vector_put(XPLMDataRef ref, int *values, int count)
+{
+    XPLMSetDatavi(ref, values, 0, count);
+}
 
-        if(testbit(switchbuf,MAG_LEFT)) {
-          XPLMCommandOnce(MagLeftSwitchOnCmd);
-         }
+static void engine_vector_put(XPLMDataRef ref, float *values, int count)
+{
+    XPLMSetDatavf(ref, values, 0, count);
+}
 
-        if(!testbit(switchbuf,MAG_LEFT)) {
-          XPLMCommandOnce(MagLeftSwitchOffCmd);
-        }
+template <typename T>
+void engine_vector_set(XPLMDataRef ref, int count, T value)
+{
+    T current[ENGINE_VECTOR_MAX], target[ENGINE_VECTOR_MAX];
 
+    if (count > ENGINE_VECTOR_MAX) {
+        count = ENGINE_VECTOR_MAX;
+    }
+    if (count <= 0) {
         return;
     }
 
-	if(testbit(switchbuf,MAG_LEFT)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(MagLeft1);
-	  }
-	  if(engnum == 2){
-	    XPLMCommandOnce(MagLeft1);
-	    XPLMCommandOnce(MagLeft2);
-	  }
-	  if(engnum == 3){
-	    XPLMCommandOnce(MagLeft1);
-	    XPLMCommandOnce(MagLeft2);
-	    XPLMCommandOnce(MagLeft3);
-	  }
-	  if(engnum == 4){
-	    XPLMCommandOnce(MagLeft1);
-	    XPLMCommandOnce(MagLeft2);
-	    XPLMCommandOnce(MagLeft3);
-	    XPLMCommandOnce(MagLeft4);
-	  }
- 	}
+    std::fill(target, target + count, value);
+    if ((engine_vector_get(ref, current, count) != count) ||
+        (!std::equal(target, target + count, current))) {
+        engine_vector_put(ref, target, count);
+    }
 }
 
-// ***************** Engines Both Mags *******************
-
-void process_engines_both_mag_switch()
+void process_switch_menu()
 {
 
-    if(magbothswitchenable == 0) {
-        return;
-    }
+    XPLMClearAllMenuItems(SwitchMenuId);
 
-   if(magbothswitchenable == 2) {
+    XPLMAppendMenuItem(SwitchMenuId, "Switch Panel Widget", (void *) "SWITCH_WIDGET", 4);
 
-        if(testbit(switchbuf,MAG_BOTH)) {
-          XPLMCommandOnce(MagBothSwitchOnCmd);
-         }
+}
 
-        if(!testbit(switchbuf,MAG_BOTH)) {
-          XPLMCommandOnce(MagBothSwitchOffCmd);
-        }
+// * battery and altenator halves of the master switch, per panel *
+void process_switch_bat_alt()
+{
+    int inverse = sw->profile->bataltinverse;
 
-        return;
-    }
+  if (inverse == 0) {
+    MASTER_BATTERY = 7, MASTER_ALTENATOR = 6;
+  }
+  if (inverse == 1) {
+    MASTER_BATTERY = 6, MASTER_ALTENATOR = 7;
+  }
+}
 
+// ***************** Switch Binding Table *******************
+// Each switch is turned into a few bindings when the ini is read, the
+// aircraft changes or the widget is used. Bindings are sorted by report
+// bit, so a report only walks the bits that actually changed.
 
-   if(testbit(switchbuf,MAG_BOTH)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(MagBoth1);
-	  }
-	  if(engnum == 2){
-	    XPLMCommandOnce(MagBoth1);
-	    XPLMCommandOnce(MagBoth2);
-	  } 
-	  if(engnum == 3){
-	    XPLMCommandOnce(MagBoth1);
-	    XPLMCommandOnce(MagBoth2);
-	    XPLMCommandOnce(MagBoth3);
-	  } 
-	  if(engnum == 4){
-	    XPLMCommandOnce(MagBoth1);
-	    XPLMCommandOnce(MagBoth2);
-	    XPLMCommandOnce(MagBoth3);
-	    XPLMCommandOnce(MagBoth4);
-	  }
-	}
+static bool switch_binding_before(const SwitchBinding &a, const SwitchBinding &b)
+{
+    return a.bit < b.bit;
 }
 
-// ***************** Engines Starting *******************
+static SwitchBinding &switch_bind(int bit, int edge, int kind)
+{
+    SwitchBinding b;
+
+    memset(&b, 0, sizeof(b));
+    b.bit = bit;
+    b.edge = edge;
+    b.kind = kind;
+    sw->bindings.push_back(b);
+    return sw->bindings.back();
+}
 
-void process_engines_start_switch()
+static SwitchBinding &switch_bind_cmd(int bit, int edge, XPLMCommandRef cmd)
 {
-    if(magstartswitchenable == 0) {
-        return;
-    }
+    SwitchBinding &b = switch_bind(bit, edge, SWITCH_ACT_COMMAND);
 
-   if(magstartswitchenable == 2) {
+    b.cmd = cmd;
+    return b;
+}
 
-        if(testbit(switchbuf,ENG_START)) {
-          XPLMCommandOnce(MagStartSwitchOnCmd);
-         }
+static SwitchBinding &switch_bind_set(int bit, int edge, int kind, XPLMDataRef ref, float value, int *count)
+{
+    SwitchBinding &b = switch_bind(bit, edge, kind);
 
-        if(!testbit(switchbuf,ENG_START)) {
-          XPLMCommandOnce(MagStartSwitchOffCmd);
-        }
+    b.ref = ref;
+    b.value = value;
+    b.count = count;
+    return b;
+}
 
-        return;
-    }
+// * a momentary switch holds its command down for as long as it is held *
+static SwitchBinding &switch_bind_hold(int bit, XPLMCommandRef cmd)
+{
+    switch_bind(bit, SWITCH_EDGE_OFF, SWITCH_ACT_HOLD).cmd = cmd;
 
-	if(testbit(switchbuf,ENG_START)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(EngStart1);
-	  }
-	  if(engnum == 2){
-	    XPLMCommandOnce(EngStart1);
-	    XPLMCommandOnce(EngStart2);
-	  }
-	  if(engnum == 3){
-	    XPLMCommandOnce(EngStart1);
-	    XPLMCommandOnce(EngStart2);
-	    XPLMCommandOnce(EngStart3);
-	  }
-	  if(engnum == 4){
-	    XPLMCommandOnce(EngStart1);
-	    XPLMCommandOnce(EngStart2);
-	    XPLMCommandOnce(EngStart3);
-	    XPLMCommandOnce(EngStart4);
-	  }
-	}
+    SwitchBinding &b = switch_bind(bit, SWITCH_EDGE_ON, SWITCH_ACT_HOLD);
+    b.cmd = cmd;
+    return b;
 }
 
-// ***************** Master Battery *******************
+static void switch_bind_gate(SwitchBinding &b, const int *gate, int gatemin)
+{
+    b.gate = gate;
+    b.gatemin = gatemin;
+}
 
-void process_master_battery_switch()
+// * remapped items get their on/off commands, returns 1 for the built in actions *
+static int switch_bind_item(int item, int bit)
 {
+    int enable = sw->profile->enable[item];
 
-    if(batmasterswitchenable == 0) {
-        return;
+    if (enable == 2) {
+        switch_bind_cmd(bit, SWITCH_EDGE_ON, sw->profile->oncmd[item]);
+        switch_bind_cmd(bit, SWITCH_EDGE_OFF, sw->profile->offcmd[item]);
     }
+    return enable == 1;
+}
+
+// * the same action on both edges, with value for on and 0 for off *
+static void switch_bind_level(int bit, int kind, XPLMDataRef ref, float value, int *count)
+{
+    switch_bind_set(bit, SWITCH_EDGE_ON, kind, ref, value, count);
+    switch_bind_set(bit, SWITCH_EDGE_OFF, kind, ref, 0, count);
+}
 
-   if(batmasterswitchenable == 2) {
+static void switch_bind_onoff(int bit, XPLMCommandRef oncmd, XPLMCommandRef offcmd)
+{
+    switch_bind_cmd(bit, SWITCH_EDGE_ON, oncmd);
+    switch_bind_cmd(bit, SWITCH_EDGE_OFF, offcmd);
+}
 
-        if(testbit(switchbuf,MASTER_BATTERY)) {
-          XPLMCommandOnce(BatMasterSwitchOnCmd);
-         }
+void SwitchPanel::bind()
+{
+    int pos, i;
 
-        if(!testbit(switchbuf,MASTER_BATTERY)) {
-          XPLMCommandOnce(BatMasterSwitchOffCmd);
-        }
+    sw = this;
+    profile = &switchprofile->panel[index];
+    release();
+    bindings.clear();
+    process_switch_bat_alt();
 
-        return;
+    // ***************** Engine Mags *******************
+    if (switch_bind_item(SWITCH_ITEM_MAG_OFF, MAG_OFF)) {
+        switch_bind_set(MAG_OFF, SWITCH_EDGE_ON, SWITCH_ACT_INT_FILL, IgnitionKeyDR, IGNITION_OFF, &engnum);
+    }
+    if (switch_bind_item(SWITCH_ITEM_MAG_RIGHT, MAG_RIGHT)) {
+        switch_bind_set(MAG_RIGHT, SWITCH_EDGE_ON, SWITCH_ACT_INT_FILL, IgnitionKeyDR, IGNITION_RIGHT, &engnum);
+    }
+    if (switch_bind_item(SWITCH_ITEM_MAG_LEFT, MAG_LEFT)) {
+        switch_bind_set(MAG_LEFT, SWITCH_EDGE_ON, SWITCH_ACT_INT_FILL, IgnitionKeyDR, IGNITION_LEFT, &engnum);
+    }
+    if (switch_bind_item(SWITCH_ITEM_MAG_BOTH, MAG_BOTH)) {
+        switch_bind_set(MAG_BOTH, SWITCH_EDGE_ON, SWITCH_ACT_INT_FILL, IgnitionKeyDR, IGNITION_BOTH, &engnum);
     }
 
-    if(testbit(switchbuf,MASTER_BATTERY)) {
+    // ***************** Engines Starting *******************
+    // * the starters stay engaged from the key going to START until it is let go *
+    if (switch_bind_item(SWITCH_ITEM_ENG_START, ENG_START)) {
+        switch_bind_gate(switch_bind_hold(ENG_START, EngStart1), &engnum, 1);
+        switch_bind_gate(switch_bind_hold(ENG_START, EngStart2), &engnum, 2);
+        switch_bind_gate(switch_bind_hold(ENG_START, EngStart3), &engnum, 3);
+        switch_bind_gate(switch_bind_hold(ENG_START, EngStart4), &engnum, 4);
+    }
+
+    // ***************** Master Battery and Altenator *******************
+    if (switch_bind_item(SWITCH_ITEM_MASTER_BATTERY, MASTER_BATTERY)) {
         if (loaded737) {
-            XPLMCommandOnce(x737gen1_on);
+            switch_bind_onoff(MASTER_BATTERY, x737gen1_on, x737gen1_off);
         } else {
-          if(batnum == 1){
-            BatArrayOn[0] = 1;
-          }
-          if(batnum == 2){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-          }
-          if(batnum == 3){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-            BatArrayOn[2] = 1;
-          }
-          if(batnum == 4){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-            BatArrayOn[2] = 1;
-            BatArrayOn[3] = 1;
-          }
-          if(batnum == 5){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-            BatArrayOn[2] = 1;
-            BatArrayOn[3] = 1;
-            BatArrayOn[4] = 1;
-          }
-          if(batnum == 6){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-            BatArrayOn[2] = 1;
-            BatArrayOn[3] = 1;
-            BatArrayOn[4] = 1;
-            BatArrayOn[5] = 1;
-          }
-          if(batnum == 7){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-            BatArrayOn[2] = 1;
-            BatArrayOn[3] = 1;
-            BatArrayOn[4] = 1;
-            BatArrayOn[5] = 1;
-            BatArrayOn[6] = 1;
-          }
-          if(batnum == 8){
-            BatArrayOn[0] = 1;
-            BatArrayOn[1] = 1;
-            BatArrayOn[2] = 1;
-            BatArrayOn[3] = 1;
-            BatArrayOn[4] = 1;
-            BatArrayOn[5] = 1;
-            BatArrayOn[6] = 1;
-            BatArrayOn[7] = 1;
-          }
+            switch_bind_level(MASTER_BATTERY, SWITCH_ACT_INT_FILL, BatArrayOnDR, 1, &batnum);
         }
     }
-    if(!testbit(switchbuf,MASTER_BATTERY)) {
+    if (switch_bind_item(SWITCH_ITEM_MASTER_ALTENATOR, MASTER_ALTENATOR)) {
         if (loaded737) {
-            XPLMCommandOnce(x737gen1_off);
+            switch_bind_onoff(MASTER_ALTENATOR, x737gen2_on, x737gen2_off);
         } else {
-          if(batnum == 1){
-            BatArrayOn[0] = 0;
-          }
-          if(batnum == 2){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-          }
-          if(batnum == 3){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-            BatArrayOn[2] = 0;
-          }
-          if(batnum == 4){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-            BatArrayOn[2] = 0;
-            BatArrayOn[3] = 0;
-          }
-          if(batnum == 5){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-            BatArrayOn[2] = 0;
-            BatArrayOn[3] = 0;
-            BatArrayOn[4] = 0;
-          }
-          if(batnum == 6){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-            BatArrayOn[2] = 0;
-            BatArrayOn[3] = 0;
-            BatArrayOn[4] = 0;
-            BatArrayOn[5] = 0;
-          }
-          if(batnum == 7){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-            BatArrayOn[2] = 0;
-            BatArrayOn[3] = 0;
-            BatArrayOn[4] = 0;
-            BatArrayOn[5] = 0;
-            BatArrayOn[6] = 0;
-          }
-          if(batnum == 8){
-            BatArrayOn[0] = 0;
-            BatArrayOn[1] = 0;
-            BatArrayOn[2] = 0;
-            BatArrayOn[3] = 0;
-            BatArrayOn[4] = 0;
-            BatArrayOn[5] = 0;
-            BatArrayOn[6] = 0;
-            BatArrayOn[7] = 0;
-          }
+            switch_bind_level(MASTER_ALTENATOR, SWITCH_ACT_INT_FILL, GenArrayOnDR, 1, &gennum);
         }
     }
 
-    if (loaded737) {
-        return;
+    // ***************** Avionics Power *******************
+    // * avionics power follows the battery while the switch is on, set when *
+    // * the switch goes on and again by power() when the battery changes *
+    if (!loaded737 && switch_bind_item(SWITCH_ITEM_AVIONICS_POWER, AVIONICS_POWER)) {
+        switch_bind_onoff(AVIONICS_POWER, AvLtOn, AvLtOff);
+        switch_bind_set(AVIONICS_POWER, SWITCH_EDGE_ON, SWITCH_ACT_BUS_INT, AvPwrOn, BUS_POWER_BATTERY, NULL);
     }
-    XPLMSetDatavi(BatArrayOnDR, BatArrayOn, 0, 8);
-}
-
-// ***************** Master Altenator *******************
 
-void process_master_altenator_switch()
-{
-
-    if(altmasterswitchenable == 0) {
-        return;
+    // ***************** Fuel Pump *******************
+    if (!loaded737 && switch_bind_item(SWITCH_ITEM_FUEL_PUMP, FUEL_PUMP)) {
+        switch_bind_level(FUEL_PUMP, SWITCH_ACT_INT_FILL, FuelPumpArrayOnDR, 1, &engnum);
     }
 
-   if(altmasterswitchenable == 2) {
-
-        if(testbit(switchbuf,MASTER_ALTENATOR)) {
-          XPLMCommandOnce(AltMasterSwitchOnCmd);
-         }
-
-        if(!testbit(switchbuf,MASTER_ALTENATOR)) {
-          XPLMCommandOnce(AltMasterSwitchOffCmd);
+    // ***************** De Ice *******************
+    if (switch_bind_item(SWITCH_ITEM_DE_ICE, DE_ICE)) {
+        if (loaded737) {
+            switch_bind_onoff(DE_ICE, x737ice_wing_on, x737ice_wing_off);
+        } else {
+            switch_bind_level(DE_ICE, SWITCH_ACT_INT, AntiIce, 1, NULL);
         }
-
-        return;
     }
 
-    if(testbit(switchbuf,MASTER_ALTENATOR)) {
+    // ***************** Pitot Heat *******************
+    if (switch_bind_item(SWITCH_ITEM_PITOT_HEAT, PITOT_HEAT)) {
         if (loaded737) {
-            XPLMCommandOnce(x737gen2_on);
+            switch_bind_onoff(PITOT_HEAT, x737ice_pitot1_on, x737ice_pitot1_off);
+            switch_bind_onoff(PITOT_HEAT, x737ice_pitot2_on, x737ice_pitot2_off);
+        } else if (wrgXPlaneVersion > 9700) {
+            switch_bind_onoff(PITOT_HEAT, PtHt0On, PtHt0Off);
+            switch_bind_onoff(PITOT_HEAT, PtHt1On, PtHt1Off);
         } else {
-          if(gennum == 1){
-            XPLMCommandOnce(GenOn1);
-          }
-          if(gennum == 2){
-            XPLMCommandOnce(GenOn1);
-            XPLMCommandOnce(GenOn2);
-          }
-          if(gennum == 3){
-            XPLMCommandOnce(GenOn1);
-            XPLMCommandOnce(GenOn2);
-            XPLMCommandOnce(GenOn3);
-          }
-          if(gennum == 4){
-            XPLMCommandOnce(GenOn1);
-            XPLMCommandOnce(GenOn2);
-            XPLMCommandOnce(GenOn3);
-            XPLMCommandOnce(GenOn4);
-          }
+            switch_bind_onoff(PITOT_HEAT, PtHtOn, PtHtOff);
         }
     }
 
-    if(!testbit(switchbuf,MASTER_ALTENATOR)) {
+    // ***************** Cowl Flaps *******************
+    // * the cowl flaps switch is open when its bit is clear *
+    if (switch_bind_item(SWITCH_ITEM_COWL_FLAPS, COWL_FLAPS)) {
         if (loaded737) {
-            XPLMCommandOnce(x737gen2_off);
+            switch_bind_onoff(COWL_FLAPS, x737ice_engine1_off, x737ice_engine1_on);
+            switch_bind_onoff(COWL_FLAPS, x737ice_engine2_off, x737ice_engine2_on);
         } else {
-          if(gennum == 1){
-            XPLMCommandOnce(GenOff1);
-          }
-          if(gennum == 2){
-            XPLMCommandOnce(GenOff1);
-            XPLMCommandOnce(GenOff2);
-          }
-          if(gennum == 3){
-            XPLMCommandOnce(GenOff1);
-            XPLMCommandOnce(GenOff2);
-            XPLMCommandOnce(GenOff3);
-          }
-          if(gennum == 4){
-            XPLMCommandOnce(GenOff1);
-            XPLMCommandOnce(GenOff2);
-            XPLMCommandOnce(GenOff3);
-            XPLMCommandOnce(GenOff4);
-          }
+            switch_bind_set(COWL_FLAPS, SWITCH_EDGE_OFF, SWITCH_ACT_FLOAT_FILL, CowlFlaps, 1.0f, &engnum);
+            switch_bind_set(COWL_FLAPS, SWITCH_EDGE_ON, SWITCH_ACT_FLOAT_FILL, CowlFlaps, 0.0f, &engnum);
         }
     }
-}
-
-// ***************** Avionics Power *******************
 
-void process_avionics_power_switch()
-{
-    if (loaded737) {
-        return;
+    // ***************** Lights *******************
+    if (!loaded737 && switch_bind_item(SWITCH_ITEM_PANEL_LIGHTS, PANEL_LIGHTS)) {
+        switch_bind_level(PANEL_LIGHTS, SWITCH_ACT_FLOAT, CockpitLights, 1, NULL);
     }
-
-    if(avionicsmasterswitchenable == 0) {
-        return;
+    if (switch_bind_item(SWITCH_ITEM_BEACON_LIGHTS, BEACON_LIGHTS)) {
+        switch_bind_onoff(BEACON_LIGHTS, BcLtOn, BcLtOff);
     }
-
-   if(avionicsmasterswitchenable == 2) {
-
-        if(testbit(switchbuf,AVIONICS_POWER)) {
-          XPLMCommandOnce(AvMasterSwitchOnCmd);
-         }
-
-        if(!testbit(switchbuf,AVIONICS_POWER)) {
-          XPLMCommandOnce(AvMasterSwitchOffCmd);
-        }
-
-        return;
+    if (switch_bind_item(SWITCH_ITEM_NAV_LIGHTS, NAV_LIGHTS)) {
+        switch_bind_onoff(NAV_LIGHTS, NvLtOn, NvLtOff);
     }
-
-
-	if(testbit(switchbuf,AVIONICS_POWER)) {
-          XPLMCommandOnce(AvLtOn);
-          if (XPLMGetDatai(BatPwrOn) == 1) {
-              XPLMSetDatai(AvPwrOn, 1);
-          }
-          if (XPLMGetDatai(BatPwrOn) == 0) {
-              XPLMSetDatai(AvPwrOn, 0);
-          }
-
- 	}
-        if(!testbit(switchbuf,AVIONICS_POWER)) {
-          XPLMCommandOnce(AvLtOff);
- 	}
-
-
-}
-
-// ***************** Fuel Pump *******************
-
-void process_fuel_pump_switch()
-{
-    if (loaded737) {
-        return;
+    if (switch_bind_item(SWITCH_ITEM_STROBE_LIGHTS, STROBE_LIGHTS)) {
+        switch_bind_onoff(STROBE_LIGHTS, StLtOn, StLtOff);
     }
-
-    if(fuelpumpswitchenable == 0) {
-        return;
+    if (switch_bind_item(SWITCH_ITEM_TAXI_LIGHTS, TAXI_LIGHTS)) {
+        switch_bind_onoff(TAXI_LIGHTS, TxLtOn, TxLtOff);
     }
-
-   if(fuelpumpswitchenable == 2) {
-
-        if(testbit(switchbuf,FUEL_PUMP)) {
-          XPLMCommandOnce(FuelPumpOnCmd);
-         }
-
-        if(!testbit(switchbuf,FUEL_PUMP)) {
-          XPLMCommandOnce(FuelPumpOffCmd);
-        }
-
-        return;
+    if (switch_bind_item(SWITCH_ITEM_LANDING_LIGHTS, LANDING_LIGHTS)) {
+        switch_bind_onoff(LANDING_LIGHTS, LnLtOn, LnLtOff);
     }
 
+    // ***************** Gear Switch *******************
+    // * the gear knob is two bits, each only acts when it comes on *
+    if (sw->profile->enable[SWITCH_ITEM_GEAR] == 2) {
+        switch_bind_cmd(GEAR_SWITCH_UP, SWITCH_EDGE_ON, sw->profile->oncmd[SWITCH_ITEM_GEAR]);
+        switch_bind_cmd(GEAR_SWITCH_DN, SWITCH_EDGE_ON, sw->profile->offcmd[SWITCH_ITEM_GEAR]);
+    }
+    if (sw->profile->enable[SWITCH_ITEM_GEAR] == 1) {
+        switch_bind_gate(switch_bind_cmd(GEAR_SWITCH_UP, SWITCH_EDGE_ON, GearUp), &gearretract, 1);
+        switch_bind_gate(switch_bind_cmd(GEAR_SWITCH_DN, SWITCH_EDGE_ON, GearDn), &gearretract, 1);
+    }
 
-    if (fuelpumpswitchenable == 2) {
-        return;
+    std::stable_sort(bindings.begin(), bindings.end(), switch_binding_before);
+    for (pos = 0, i = 0; pos < SWITCH_REPORT_BITS; pos++) {
+        bitstart[pos] = i;
+        while ((i < (int) bindings.size()) && (bindings[i].bit == pos)) {
+            i++;
+        }
     }
+    bitstart[SWITCH_REPORT_BITS] = i;
 
-	if(testbit(switchbuf,FUEL_PUMP)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(FuelPumpOn1);
-	  }
-	  if(engnum == 2){
-	    XPLMCommandOnce(FuelPumpOn1);
-	    XPLMCommandOnce(FuelPumpOn2);
-	  }
-	  if(engnum == 3){
-	    XPLMCommandOnce(FuelPumpOn1);
-	    XPLMCommandOnce(FuelPumpOn2);
-	    XPLMCommandOnce(FuelPumpOn3);
-	  }
-	  if(engnum == 4){
-	    XPLMCommandOnce(FuelPumpOn1);
-	    XPLMCommandOnce(FuelPumpOn2);
-	    XPLMCommandOnce(FuelPumpOn3);
-	    XPLMCommandOnce(FuelPumpOn4);
-	  }
- 	}
-	if(!testbit(switchbuf,FUEL_PUMP)) {
-	  if(engnum == 1){
-	    XPLMCommandOnce(FuelPumpOff1);
-	  }
-	  if(engnum == 2){
-	    XPLMCommandOnce(FuelPumpOff1);
-	    XPLMCommandOnce(FuelPumpOff2);
-	  }
-	  if(engnum == 3){
-	    XPLMCommandOnce(FuelPumpOff1);
-	    XPLMCommandOnce(FuelPumpOff2);
-	    XPLMCommandOnce(FuelPumpOff3);
-	  }
-	  if(engnum == 4){
-	    XPLMCommandOnce(FuelPumpOff1);
-	    XPLMCommandOnce(FuelPumpOff2);
-	    XPLMCommandOnce(FuelPumpOff3);
-	    XPLMCommandOnce(FuelPumpOff4);
-	  }
- 	}
+    bindgen = switchbindgen;
+    bind737 = loaded737;
+    // * the first report after a rebind sets every switch as it stands *
+    resyncmask = PANEL_BIT(SWITCH_REPORT_BITS) - 1;
 }
 
-// ***************** De Ice *******************
-
-void process_de_ice_switch()
+// ***************** Active Held Commands *******************
+// Every XPLMCommandBegin is remembered until its XPLMCommandEnd, so a
+// command is never begun twice or ended without being begun, and anything
+// still held is let go on a rebind or when the panel is closed.
+static void switch_hold_begin(XPLMCommandRef cmd)
 {
-    if(deiceswitchenable == 0) {
+    if (std::find(sw->activecmds.begin(), sw->activecmds.end(), cmd) != sw->activecmds.end()) {
         return;
     }
+    XPLMCommandBegin(cmd);
+    sw->activecmds.push_back(cmd);
+}
 
-   if(deiceswitchenable == 2) {
-
-        if(testbit(switchbuf,DE_ICE)) {
-          XPLMCommandOnce(DeiceOnCmd);
-         }
-
-        if(!testbit(switchbuf,DE_ICE)) {
-          XPLMCommandOnce(DeiceOffCmd);
-        }
+static void switch_hold_end(XPLMCommandRef cmd)
+{
+    std::vector<XPLMCommandRef>::iterator it = std::find(sw->activecmds.begin(), sw->activecmds.end(), cmd);
 
+    if (it == sw->activecmds.end()) {
         return;
     }
-
-
-
-	if(testbit(switchbuf,DE_ICE)) {
-
-            if (loaded737 == 1){
-                XPLMCommandOnce(x737ice_wing_on);
-            } else {
-                XPLMSetDatai(AntiIce, 1);
-            }
-
- 	}
-	if(!testbit(switchbuf,DE_ICE)) {
-
-            if (loaded737 == 1){
-                XPLMCommandOnce(x737ice_wing_off);
-            } else {
-                XPLMSetDatai(AntiIce, 0);
-            }
-     }
+    XPLMCommandEnd(cmd);
+    sw->activecmds.erase(it);
 }
 
-// ***************** Pitot Heat *******************
-
-void process_pitot_heat_switch()
+void SwitchPanel::release()
 {
+    int i;
 
-    if(pitotheatswitchenable == 0) {
-        return;
+    for (i = 0; i < (int) activecmds.size(); i++) {
+        XPLMCommandEnd(activecmds[i]);
     }
+    activecmds.clear();
+}
 
-   if(pitotheatswitchenable == 2) {
-
-        if(testbit(switchbuf,PITOT_HEAT)) {
-          XPLMCommandOnce(PitotHeatOnCmd);
-         }
-
-        if(!testbit(switchbuf,PITOT_HEAT)) {
-          XPLMCommandOnce(PitotHeatOffCmd);
-        }
-
-        return;
+static void switch_binding_run(const SwitchBinding &b)
+{
+    // * always let go of a held command, even if the gate has closed since *
+    if ((b.kind == SWITCH_ACT_HOLD) && (b.edge == SWITCH_EDGE_OFF)) {
+        switch_hold_end(b.cmd);
+        return;
+    }
+
+    if ((b.gate != NULL) && (*b.gate < b.gatemin)) {
+        return;
+    }
+
+    switch (b.kind) {
+    case SWITCH_ACT_COMMAND:
+        XPLMCommandOnce(b.cmd);
+        break;
+    case SWITCH_ACT_HOLD:
+        switch_hold_begin(b.cmd);
+        break;
+    case SWITCH_ACT_INT:
+        XPLMSetDatai(b.ref, (int) b.value);
+        break;
+    case SWITCH_ACT_FLOAT:
+        XPLMSetDataf(b.ref, b.value);
+        break;
+    case SWITCH_ACT_INT_FILL:
+        engine_vector_set(b.ref, *b.count, (int) b.value);
+        break;
+    case SWITCH_ACT_FLOAT_FILL:
+        engine_vector_set(b.ref, *b.count, b.value);
+        break;
+    case SWITCH_ACT_BUS_INT:
+        XPLMSetDatai(b.ref, (buspower & (int) b.value) != 0);
+        break;
     }
-
-
-	if(testbit(switchbuf,PITOT_HEAT)) {
-
-            if (loaded737 == 1){
-                XPLMCommandOnce(x737ice_pitot1_on);
-                XPLMCommandOnce(x737ice_pitot2_on);
-            } else {
-                if (wrgXPlaneVersion > 9700){
-                    XPLMCommandOnce(PtHt0On);
-                    XPLMCommandOnce(PtHt1On);
-                } else {
-                    XPLMCommandOnce(PtHtOn);
-                }
-            }
-
- 	}
-	if(!testbit(switchbuf,PITOT_HEAT)) {
-
-            if (loaded737 == 1){
-                XPLMCommandOnce(x737ice_pitot1_off);
-                XPLMCommandOnce(x737ice_pitot2_off);
-            } else {
-                if (wrgXPlaneVersion > 9700){
-                    XPLMCommandOnce(PtHt0Off);
-                    XPLMCommandOnce(PtHt1Off);
-                } else {
-                    XPLMCommandOnce(PtHtOff);
-                }
-            }
-
- 	}
 }
 
-// ***************** Cowl Flaps *******************
-
-void process_cowl_flaps_switch()
+// ***************** Switch Executor *******************
+void SwitchPanel::dispatch(panel_word word)
 {
-    if(cowlflapsenable == 0) {
-        return;
+    panel_word changed = (word ^ lastword) | resyncmask;
+    int pos, i, edge;
+
+    lastword = word;
+    resyncmask = 0;
+
+    // * lowest changed bit first, clearing each one as it is handled *
+    for (; changed != 0; changed &= changed - 1) {
+        pos = panel_ctz(changed);
+        edge = panel_test(word, pos) ? SWITCH_EDGE_ON : SWITCH_EDGE_OFF;
+        for (i = bitstart[pos]; i < bitstart[pos + 1]; i++) {
+            if (bindings[i].edge == edge) {
+                switch_binding_run(bindings[i]);
+            }
+        }
     }
+}
 
-    if(cowlflapsenable == 2) {
-
-         if(testbit(switchbuf,COWL_FLAPS)) {
-           XPLMCommandOnce(CowlFlapsOpenCmd);
-          }
-
-         if(!testbit(switchbuf,COWL_FLAPS)) {
-           XPLMCommandOnce(CowlFlapsCloseCmd);
-         }
-
-         return;
-     }
-
-
-        if(!testbit(switchbuf,COWL_FLAPS)) {
-          if (loaded737 == 1){
-                XPLMCommandOnce(x737ice_engine1_on);
-                XPLMCommandOnce(x737ice_engine2_on);
-          } else {
-          if(engnum == 1){
-            opencowl[0] = 1;
-          }
-
-	  if(engnum == 2){
-            opencowl[0] = 1;
-            opencowl[1] = 1;
-
-	  }
-	  if(engnum == 3){
-            opencowl[0] = 1;
-            opencowl[1] = 1;
-            opencowl[2] = 1;
-
-	  }
-	  if(engnum == 4){
-            opencowl[0] = 1;
-            opencowl[1] = 1;
-            opencowl[2] = 1;
-            opencowl[3] = 1;
-
-	  }
-          XPLMSetDatavf(CowlFlaps, opencowl, 0, 8);
- 	}
+// ***************** Gear Indicator Stage *******************
+// Once per frame each leg (nose, left, right) is quantised into a 4 bit
+// key, deploy state in the low two bits and failure overlay in the high
+// two. The LED byte is only rebuilt when the combined key changes, from
+// gearlegled. Green LEDs are bits 0-2 and red LEDs bits 3-5.
+
+#define GEAR_LEG_UP        0
+#define GEAR_LEG_TRANSIT   1
+#define GEAR_LEG_DOWN      2
+
+#define GEAR_FAIL_NONE     (0<<2)
+#define GEAR_FAIL_DARK     (1<<2)
+#define GEAR_FAIL_RED      (2<<2)
+#define GEAR_FAIL_GREEN    (3<<2)
+
+#define GEAR_KEY_GROUND_UP (1<<12)
+#define GEAR_KEY_FIXED     (1<<13)
+
+#define GEAR_GREEN 0x01
+#define GEAR_RED   0x08
+
+static const unsigned char gearlegled[16] = {
+    // * no failure: up, in motion, down and locked *
+    0,          GEAR_RED,   GEAR_GREEN, 0,
+    // * failed while selected up *
+    0,          0,          0,          0,
+    // * failed, then the knob was moved the other way *
+    GEAR_RED,   GEAR_RED,   GEAR_RED,   GEAR_RED,
+    // * failed while selected down *
+    GEAR_GREEN, GEAR_GREEN, GEAR_GREEN, GEAR_GREEN
+};
+
+int gear_leg_deploy(float ratio)
+{
+    if (ratio <= 0) {
+        return GEAR_LEG_UP;
     }
-
-        if(testbit(switchbuf,COWL_FLAPS)) {
-            if (loaded737 == 1){
-                XPLMCommandOnce(x737ice_engine1_off);
-                XPLMCommandOnce(x737ice_engine2_off);
-            } else {
-              if(engnum == 1){
-                closecowl[0] = 0;
-
-	  }
-	  if(engnum == 2){
-            closecowl[0] = 0;
-            closecowl[1] = 0;
-
-	  }
-	  if(engnum == 3){
-            closecowl[0] = 0;
-            closecowl[1] = 0;
-            closecowl[2] = 0;
-
-	  }
-	  if(engnum == 4){
-            closecowl[0] = 0;
-            closecowl[1] = 0;
-            closecowl[2] = 0;
-            closecowl[3] = 0;
-
-	  }
-          XPLMSetDatavf(CowlFlaps, closecowl, 0, 8);
- 	}
+    if (ratio >= 1) {
+        return GEAR_LEG_DOWN;
     }
+    return GEAR_LEG_TRANSIT;
 }
 
-// ***************** Panel Lights *******************
-
-void process_panel_lights_switch()
+// * a failure (value 6) is latched against the knob position it happened in *
+int gear_leg_fail(int leg, int fail)
 {
-    if (loaded737) {
-        return;
+    if(panel_test(sw->lastword, GEAR_SWITCH_UP)) {
+        if (sw->gearfaildn[leg] == 1) {
+            return GEAR_FAIL_RED;
+        }
+        if (fail == 6) {
+            sw->gearfailup[leg] = 1;
+        }
+        if (fail == 0) {
+            sw->gearfailup[leg] = 0;
+        }
+        return sw->gearfailup[leg] ? GEAR_FAIL_DARK : GEAR_FAIL_NONE;
     }
 
-    if(panellightswitchenable == 0) {
-        return;
+    if(panel_test(sw->lastword, GEAR_SWITCH_DN)) {
+        if (sw->gearfailup[leg] == 1) {
+            return GEAR_FAIL_RED;
+        }
+        if (fail == 6) {
+            sw->gearfaildn[leg] = 1;
+        }
+        if (fail == 0) {
+            sw->gearfaildn[leg] = 0;
+        }
+        return sw->gearfaildn[leg] ? GEAR_FAIL_GREEN : GEAR_FAIL_NONE;
     }
 
-    if(panellightswitchenable == 2) {
-
-         if(testbit(switchbuf,PANEL_LIGHTS)) {
-           XPLMCommandOnce(PanelLightsOnCmd);
-          }
-
-         if(!testbit(switchbuf,PANEL_LIGHTS)) {
-           XPLMCommandOnce(PanelLightsOffCmd);
-         }
-
-         return;
-     }
-
-
-
-	if(testbit(switchbuf,PANEL_LIGHTS)) {
-	  XPLMSetDataf(CockpitLights, 1);
-	}
-	if(!testbit(switchbuf,PANEL_LIGHTS)) {
-	  XPLMSetDataf(CockpitLights, 0);
-	}
+    return GEAR_FAIL_NONE;
 }
 
-// ***************** Beacon Lights *******************
-
-void process_beacon_lights_switch()
+unsigned char gear_led_for_key(int key)
 {
+    unsigned char led = 0;
+    int leg;
 
-    if(beaconlightswitchenable == 0) {
-        return;
+    if (key & GEAR_KEY_FIXED) {
+        return 0x00;
     }
-
-    if(beaconlightswitchenable == 2) {
-
-         if(testbit(switchbuf,BEACON_LIGHTS)) {
-           XPLMCommandOnce(BeaconLightsOnCmd);
-          }
-
-         if(!testbit(switchbuf,BEACON_LIGHTS)) {
-           XPLMCommandOnce(BeaconLightsOffCmd);
-         }
-
-         return;
-     }
-
-	if(testbit(switchbuf,BEACON_LIGHTS)) {
-          XPLMCommandOnce(BcLtOn);
- 	}
-	if(!testbit(switchbuf,BEACON_LIGHTS)) {
-          XPLMCommandOnce(BcLtOff);
- 	}
+    // * on the ground with the knob up every leg shows red *
+    if (key & GEAR_KEY_GROUND_UP) {
+        return 0x38;
+    }
+    for (leg = 0; leg < 3; leg++) {
+        led |= gearlegled[(key >> (leg * 4)) & 0x0F] << leg;
+    }
+    return led;
 }
 
-// ***************** Nav Lights *******************
-
-void process_nav_lights_switch()
+void process_gear_indicator()
 {
+    int key = 0, leg;
 
-    if(navlightswitchenable == 0) {
+    if(sw->profile->enable[SWITCH_ITEM_GEAR] != 1) {
         return;
     }
 
-    if(navlightswitchenable == 2) {
-
-         if(testbit(switchbuf,NAV_LIGHTS)) {
-           XPLMCommandOnce(NavLightsOnCmd);
-          }
-
-         if(!testbit(switchbuf,NAV_LIGHTS)) {
-           XPLMCommandOnce(NavLightsOffCmd);
-         }
-
-         return;
-     }
+    if(gearretract){
+        for (leg = 0; leg < 3; leg++) {
+            key |= (gear_leg_deploy(snapgearratio[leg]) | gear_leg_fail(leg, snapgearfail[leg])) << (leg * 4);
+        }
+        if(panel_test(sw->lastword, GEAR_SWITCH_UP) && snaponground) {
+            key |= GEAR_KEY_GROUND_UP;
+        }
+    } else {
+        key = GEAR_KEY_FIXED;
+    }
 
-	if(testbit(switchbuf,NAV_LIGHTS)) {
-          XPLMCommandOnce(NvLtOn);
- 	}
-	if(!testbit(switchbuf,NAV_LIGHTS)) {
-          XPLMCommandOnce(NvLtOff);
- 	}
+    if (key != sw->gearstatekey) {
+        sw->gearstatekey = key;
+        sw->gearled = gear_led_for_key(key);
+    }
 }
 
-// ***************** Strobe Lights *******************
 
-void process_strobe_lights_switch()
+// ***************** Send Gear LEDS on Change *******************
+// Only write when the LED byte changes, plus a slow keepalive in case the
+// panel missed a report.
+void SwitchPanel::send()
 {
+    float now = XPLMGetElapsedTime();
 
-    if(strobelightswitchenable == 0) {
-        return;
+    if ((write_buffer[1] != lastgearled) || ((now - lastwrite) > switchkeepalive)) {
+        switchwres = hid_send_feature_report(handle, write_buffer, 2);
+        usbwrites++;
+        switchusbwrites++;
+        lastgearled = write_buffer[1];
+        lastwrite = now;
     }
+}
 
-    if(strobelightswitchenable == 2) {
+SwitchPanel::SwitchPanel(hid_device *device, int idx)
+{
+    int leg;
+
+    handle = device;
+    index = idx;
+    profile = &switchprofile->panel[idx];
+
+    memset(read_buffer, 0, sizeof(read_buffer));
+    memset(write_buffer, 0, sizeof(write_buffer));
+    gearled = 0, lastgearled = 0;
+    for (leg = 0; leg < 3; leg++) {
+        gearfailup[leg] = 0, gearfaildn[leg] = 0;
+    }
+    gearstatekey = -1;
+    lastwrite = 0;
+    lastword = 0, resyncmask = 0;
+    powered = 1;
+    bindgen = -1, bind737 = -1;
+    memset(bitstart, 0, sizeof(bitstart));
+    reports = 0, usbwrites = 0, frames = 0;
+    servicetime = 0, servicepeak = 0;
+
+    hid_set_nonblocking(handle, 1);
+    hid_read(handle, read_buffer, sizeof(read_buffer));
+    hid_send_feature_report(handle, write_buffer, 2);
+}
 
-         if(testbit(switchbuf,STROBE_LIGHTS)) {
-           XPLMCommandOnce(StrobeLightsOnCmd);
-          }
+SwitchPanel::~SwitchPanel()
+{
+    char costbuf[160];
 
-         if(!testbit(switchbuf,STROBE_LIGHTS)) {
-           XPLMCommandOnce(StrobeLightsOffCmd);
-         }
+    release();
 
-         return;
-     }
+    write_buffer[0] = 0;
+    write_buffer[1] = 0;
+    hid_send_feature_report(handle, write_buffer, 2);
+    hid_close(handle);
 
-	if(testbit(switchbuf,STROBE_LIGHTS)) {
-          XPLMCommandOnce(StLtOn);
- 	}
-	if(!testbit(switchbuf,STROBE_LIGHTS)) {
-          XPLMCommandOnce(StLtOff);
- 	}
+    sprintf(costbuf, "Xsaitekpanels: switch panel %d read %d reports, wrote %d times, %.1f us a frame (peak %.1f us)\n",
+            index + 1, reports, usbwrites, (frames > 0) ? servicetime / frames : 0.0, servicepeak);
+    XPLMDebugString(costbuf);
 }
 
-// ***************** Taxi Lights *******************
-
-void process_taxi_lights_switch()
+// * the gear LEDs go dark with the battery, send() writes the change once *
+void SwitchPanel::power(int state)
 {
-
-    if(taxilightswitchenable == 0) {
-        return;
+    int battery = ((state & BUS_POWER_BATTERY) != 0);
+    int i;
+
+    // * bus followers on a switch that is on take the battery change *
+    if (battery != powered) {
+        for (i = 0; i < (int) bindings.size(); i++) {
+            if ((bindings[i].kind == SWITCH_ACT_BUS_INT) && (bindings[i].edge == SWITCH_EDGE_ON) &&
+                panel_test(lastword, bindings[i].bit)) {
+                switch_binding_run(bindings[i]);
+            }
+        }
     }
-
-    if(taxilightswitchenable == 2) {
-
-         if(testbit(switchbuf,TAXI_LIGHTS)) {
-           XPLMCommandOnce(TaxiLightsOnCmd);
-          }
-
-         if(!testbit(switchbuf,TAXI_LIGHTS)) {
-           XPLMCommandOnce(TaxiLightsOffCmd);
-         }
-
-         return;
-     }
-
-	if(testbit(switchbuf,TAXI_LIGHTS)) {
-          XPLMCommandOnce(TxLtOn);
- 	}
-	if(!testbit(switchbuf,TAXI_LIGHTS)) {
-          XPLMCommandOnce(TxLtOff);
- 	}
+    powered = battery;
 }
 
-// ***************** Landing Lights *******************
-
-void process_landing_lights_switch()
+// ***** One Switch Panel *****
+void SwitchPanel::update()
 {
+    double start = panel_clock_us(), spent;
 
-    if(landinglightswitchenable == 0) {
-        return;
+    sw = this;
+    if ((bindgen != switchbindgen) || (bind737 != loaded737)) {
+        bind();
     }
 
-    if(landinglightswitchenable == 2) {
+    // ******* Only do a read if something new to be read ********
 
-         if(testbit(switchbuf,LANDING_LIGHTS)) {
-           XPLMCommandOnce(LandingLightsOnCmd);
-          }
+      int switch_safety_cntr = 30;
+      do{
+        switchres = hid_read(handle, read_buffer, sizeof(read_buffer));
+        if (switchres > 0) {
+            reports++;
+            dispatch(panel_report_word(read_buffer));
+        }
+        --switch_safety_cntr;
+      }while((switchres > 0) && (switch_safety_cntr > 0));
 
-         if(!testbit(switchbuf,LANDING_LIGHTS)) {
-           XPLMCommandOnce(LandingLightsOffCmd);
-         }
+      if (resyncmask != 0) {
+          dispatch(panel_report_word(read_buffer));
+      }
 
-         return;
-     }
+      process_gear_indicator();
 
-	if(testbit(switchbuf,LANDING_LIGHTS)) {
-          XPLMCommandOnce(LnLtOn);
- 	}
-	if(!testbit(switchbuf,LANDING_LIGHTS)) {
-          XPLMCommandOnce(LnLtOff);
- 	}
-}
+      write_buffer[0] = 0;
+      write_buffer[1] = powered ? gearled : 0;
 
-// ***************** Gear Switch *******************
+    // * if no gear do not write *
 
+      if(gearretract){
+        send();
+      }
 
-void process_gear_switch_switch()
-{
-    if(landinggearknobupenable == 0) {
-        return;
+    spent = panel_clock_us() - start;
+    servicetime += spent;
+    if (spent > servicepeak) {
+        servicepeak = spent;
     }
+    frames++;
+}
 
-    if(landinggearknobupenable == 2) {
-
-        if(testbit(switchbuf,GEAR_SWITCH_UP)) {
-          XPLMCommandOnce(GearUpCmd);
-         }
+// ***************** Aircraft Constants *******************
+// Called on XPLM_MSG_PLANE_LOADED for the user aircraft.
+void process_switch_aircraft()
+{
+    batnum = XPLMGetDatai(BatNum);
+    gennum = XPLMGetDatai(GenNum);
+    engnum = XPLMGetDatai(EngNum);
+    gearretract = (XPLMGetDatai(GearRetract) > 0);
+    switchaircraftread = 1;
+}
 
-        if(testbit(switchbuf,GEAR_SWITCH_DN)) {
-          XPLMCommandOnce(GearDnCmd);
-        }
+// ***************** Frame Snapshot *******************
+void process_switch_snapshot()
+{
+    XPLMDataRef gearfailref[3] = {Gear1Fail, Gear2Fail, Gear3Fail};
+    int leg;
 
+    if (!gearretract) {
         return;
     }
-
-
-	
-	if(XPLMGetDatai(GearRetract) > 0){
-          XPLMGetDatavf(LandingGearStatus, LandingGearDeployRatio, 0, 10);
-          // Gear is down and locked
-          if (LandingGearDeployRatio[0] == 1) {
-              gearled |= (1<<0);   // * set bit 0 in gearled to 1 *
-              gearled &= ~(1<<3);   // * clear bit 3 in gearled to 0 *
-          }
-          if (LandingGearDeployRatio[1] == 1) {
-              gearled |= (1<<1);   // * set bit 1 in gearled to 1 *
-              gearled &= ~(1<<4);   // * clear bit 4 in gearled to 0 *
-          }
-          if (LandingGearDeployRatio[2] == 1) {
-              gearled |= (1<<2);   // * set bit 2 in gearled to 1 *
-              gearled &= ~(1<<5);   // * clear bit 5 in gearled to 0 *
-          }
-          // Gear is in motion
-          if ((LandingGearDeployRatio[0] > 0) &&(LandingGearDeployRatio[0] < 1)) {
-              gearled |= (1<<3);   // * set bit 3 in gearled to 1 *
-              gearled &= ~(1<<0);   // * clear bit 0 in gearled to 0 *
-          }
-          if ((LandingGearDeployRatio[1] > 0) &&(LandingGearDeployRatio[1] < 1)) {
-              gearled |= (1<<4);   // * set bit 4 in gearled to 1 *
-              gearled &= ~(1<<1);   // * clear bit 1 in gearled to 0 *
-          }
-          if ((LandingGearDeployRatio[2] > 0) &&(LandingGearDeployRatio[2] < 1)) {
-              gearled |= (1<<5);   // * set bit 5 in gearled to 1 *
-              gearled &= ~(1<<2);   // * clear bit 2 in gearled to 0 *
-          }
-          // Gear is up
-          if (LandingGearDeployRatio[0] == 0) {
-              gearled &= ~(1<<0);   // * clear bit 0 in gearled to 0 *
-              gearled &= ~(1<<3);   // * clear bit 3 in gearled to 0 *
-          }
-          if (LandingGearDeployRatio[1] == 0) {
-              gearled &= ~(1<<1);   // * clear bit 1 in gearled to 0 *
-              gearled &= ~(1<<4);   // * clear bit 4 in gearled to 0 *
-          }
-          if (LandingGearDeployRatio[2] == 0) {
-              gearled &= ~(1<<2);   // * clear bit 2 in gearled to 0 *
-              gearled &= ~(1<<5);   // * clear bit 5 in gearled to 0 *
-          }
-          // Gear has failed
-
-          if(testbit(switchbuf,GEAR_SWITCH_UP)) {
-
-             // ********************************************************************************************
-             // Nose gear had failed
-
-             if (failed1dn == 0) {
-               if (XPLMGetDatai(Gear1Fail) == 6) {
-                 failed1up = 1;
-               }
-               if (XPLMGetDatai(Gear1Fail) == 0) {
-                 failed1up = 0;
-               }
-               if (failed1up == 1) {
-                   gearled &= ~(1<<3);   // * set bit 3 in gearled to 1 *
-                   gearled &= ~(1<<0);   // * clear bit 1 in gearled to 0 *
-               }
-
-             }
-             if (failed1dn == 1) {
-                 gearled |= (1<<3);   // * set bit 3 in gearled to 1 *
-                 gearled &= ~(1<<0);   // * clear bit 0 in gearled to 0 *
-             }
-
-             // *********************************************************************************************
-             // Left gear has failed
-
-             if (failed2dn == 0) {
-               if (XPLMGetDatai(Gear2Fail) == 6) {
-                 failed2up = 1;
-               }
-               if (XPLMGetDatai(Gear2Fail) == 0) {
-                 failed2up = 0;
-               }
-               if (failed2up == 1) {
-                   gearled &= ~(1<<4);   // * set bit 3 in gearled to 1 *
-                   gearled &= ~(1<<1);   // * clear bit 1 in gearled to 0 *
-               }
-
-             }
-             if (failed2dn == 1) {
-                 gearled |= (1<<4);   // * set bit 3 in gearled to 1 *
-                 gearled &= ~(1<<1);   // * clear bit 0 in gearled to 0 *
-             }
-
-             // **************************************************************************************************
-             // Right gear has failed
-
-             if (failed3dn == 0) {
-               if (XPLMGetDatai(Gear3Fail) == 6) {
-                 failed3up = 1;
-               }
-               if (XPLMGetDatai(Gear3Fail) == 0) {
-                 failed3up = 0;
-               }
-               if (failed3up == 1) {
-                   gearled &= ~(1<<5);   // * set bit 3 in gearled to 1 *
-                   gearled &= ~(1<<2);   // * clear bit 1 in gearled to 0 *
-               }
-
-             }
-             if (failed3dn == 1) {
-                 gearled |= (1<<5);   // * set bit 3 in gearled to 1 *
-                 gearled &= ~(1<<2);   // * clear bit 0 in gearled to 0 *
-             }
-
-
-
-           }
-
-          if(testbit(switchbuf,GEAR_SWITCH_DN)) {
-
-              // ******************************************************************************************************
-             // Nose gear has failed
-
-             if (failed1up == 0) {
-               if (XPLMGetDatai(Gear1Fail) == 6) {
-                 failed1dn = 1;
-               }
-               if (XPLMGetDatai(Gear1Fail) == 0) {
-                 failed1dn = 0;
-               }
-               if (failed1dn == 1) {
-                   gearled |= (1<<0);   // * set bit 0 in gearled to 1 *
-                   gearled &= ~(1<<3);   // * clear bit 3 in gearled to 0 *
-               }
-
-             }
-             if (failed1up == 1) {
-                 gearled |= (1<<3);   // * set bit 3 in gearled to 1 *
-                 gearled &= ~(1<<0);   // * clear bit 0 in gearled to 0 *
-             }
-
-             // *******************************************************************************************************
-             // Left gear has failed
-
-             if (failed2up == 0) {
-               if (XPLMGetDatai(Gear2Fail) == 6) {
-                 failed2dn = 1;
-               }
-               if (XPLMGetDatai(Gear2Fail) == 0) {
-                 failed2dn = 0;
-               }
-               if (failed2dn == 1) {
-                   gearled |= (1<<1);   // * set bit 0 in gearled to 1 *
-                   gearled &= ~(1<<4);   // * clear bit 3 in gearled to 0 *
-               }
-
-             }
-             if (failed2up == 1) {
-                 gearled |= (1<<4);   // * set bit 3 in gearled to 1 *
-                 gearled &= ~(1<<1);   // * clear bit 0 in gearled to 0 *
-             }
-
-             // *******************************************************************************************************
-             // Right gear has failed
-
-             if (failed3up == 0) {
-               if (XPLMGetDatai(Gear3Fail) == 6) {
-                 failed3dn = 1;
-               }
-               if (XPLMGetDatai(Gear3Fail) == 0) {
-                 failed3dn = 0;
-               }
-               if (failed3dn == 1) {
-                   gearled |= (1<<2);   // * set bit 0 in gearled to 1 *
-                   gearled &= ~(1<<5);   // * clear bit 3 in gearled to 0 *
-               }
-
-             }
-             if (failed3up == 1) {
-                 gearled |= (1<<5);   // * set bit 3 in gearled to 1 *
-                 gearled &= ~(1<<2);   // * clear bit 0 in gearled to 0 *
-             }
-
-          }
-
-	  if(testbit(switchbuf,GEAR_SWITCH_UP)) {
-            XPLMCommandOnce(GearUp);
-            if(XPLMGetDatai(OnGround) > 0){
-              gearled = 0x38;
-            }
-
-          }
-
-	  if(testbit(switchbuf,GEAR_SWITCH_DN)) {
-            XPLMCommandOnce(GearDn);
- 	  }
-
-	}
-	if(XPLMGetDatai(GearRetract) == 0){
-	  gearled = 0x00;
-	}
+    snaponground = (XPLMGetDatai(OnGround) > 0);
+    XPLMGetDatavf(LandingGearStatus, snapgearratio, 0, 3);
+    for (leg = 0; leg < 3; leg++) {
+        snapgearfail[leg] = XPLMGetDatai(gearfailref[leg]);
+    }
 }
 
-
 //  ***** Switch Panel Process  *****
+// Every connected switch panel is serviced in turn from the flight loop.
 void process_switch_panel()
 
 {
     process_switch_menu();
 
-    // ******* Only do a read if something new to be read ********
-
-      hid_set_nonblocking(switchhandle, 1);
-      int switch_safety_cntr = 30;
-      do{
-        switchres = hid_read(switchhandle, switchbuf, sizeof(switchbuf));
-        process_engines_mag_off_switch();
-        process_engines_right_mag_switch();
-        process_engines_left_mag_switch();
-        process_engines_both_mag_switch();
-        process_engines_start_switch();
-        process_master_battery_switch();
-        process_master_altenator_switch();
-        process_avionics_power_switch();
-        process_fuel_pump_switch();
-        process_de_ice_switch();
-        process_pitot_heat_switch();
-        process_cowl_flaps_switch();
-        process_panel_lights_switch();
-        process_beacon_lights_switch();
-        process_nav_lights_switch();
-        process_strobe_lights_switch();
-        process_taxi_lights_switch();
-        process_landing_lights_switch();
-        process_gear_switch_switch();
-
-        --switch_safety_cntr;
-      }while((switchres > 0) && (switch_safety_cntr > 0));
-
-      switchnowrite = 1;
-
-    // * if no gear do not write *
-
-      if(XPLMGetDatai(GearRetract) > 0){
-        if (XPLMGetDatai(BatPwrOn) == 0) {
-              switchwbuf[0] = 0, switchwbuf[1] = 0;
-              switchwres = hid_send_feature_report(switchhandle, switchwbuf, 2);
-        }
-        if (XPLMGetDatai(BatPwrOn) == 1) {
-              switchwres = hid_send_feature_report(switchhandle, switchwbuf, 2);
-        }
-      }
-      else {
-      }
+    if (!switchaircraftread) {
+        process_switch_aircraft();
+    }
+    process_switch_snapshot();
 
-      batnum = XPLMGetDatai(BatNum), gennum = XPLMGetDatai(GenNum), engnum = XPLMGetDatai(EngNum);
+    for (std::list<SwitchPanel *>::iterator it = switchpanels.begin(); it != switchpanels.end(); it++) {
+        (*it)->update();
+    }
+    sw = NULL;
 
   return;
 }